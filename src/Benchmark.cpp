@@ -0,0 +1,110 @@
+/**
+ * Copyright (c) 2020-2021. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "Benchmark.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include "ParameterSweep.h"
+#include "WorkflowGenerator.h"
+
+const std::string Benchmark::CSV_HEADER = "shape,tasks,algorithm,wall_time_s,max_rss_kb,events,events_per_s";
+
+/**
+ * @brief Constructor
+ *
+ * @param executable: path to the simulator executable
+ * @param platform_file: the platform on which workflows are simulated
+ * @param output_file: path to the benchmark report (CSV)
+ * @param sizes: the numbers of tasks of the synthetic workflows
+ * @param algorithms: the scheduling algorithms
+ * @param num_workers: maximum number of simulations running at the same time (1 for accurate timings)
+ * @param common_args: arguments passed to every simulation
+ *
+ * @throw std::invalid_argument
+ */
+Benchmark::Benchmark(std::string executable,
+                     std::string platform_file,
+                     std::string output_file,
+                     std::vector<unsigned long> sizes,
+                     std::vector<std::string> algorithms,
+                     unsigned int num_workers,
+                     std::vector<std::string> common_args) :
+        executable(std::move(executable)),
+        platform_file(std::move(platform_file)),
+        output_file(std::move(output_file)),
+        sizes(std::move(sizes)),
+        algorithms(std::move(algorithms)),
+        num_workers(num_workers),
+        common_args(std::move(common_args)) {
+    if (this->sizes.empty() || this->algorithms.empty()) {
+        throw std::invalid_argument("Benchmark::Benchmark(): no workflow size or no algorithm to benchmark");
+    }
+}
+
+/**
+ * @brief Run the benchmark simulations and write the report
+ *
+ * @return 0 if all simulations succeeded, 1 otherwise
+ */
+int Benchmark::run() {
+    struct BenchmarkCase {
+        std::string shape;
+        unsigned long size;
+        std::string algorithm;
+        std::string stats_file;
+    };
+
+    std::vector<BenchmarkCase> cases;
+    std::vector<std::vector<std::string>> job_args;
+    for (auto &shape : WorkflowGenerator::SHAPES) {
+        for (auto size : this->sizes) {
+            for (auto &algorithm : this->algorithms) {
+                BenchmarkCase benchmark_case = {shape, size, algorithm,
+                                                this->output_file + ".stats." + std::to_string(cases.size())};
+                job_args.push_back({this->platform_file, WorkflowGenerator::getSpecification(shape, size), shape,
+                                    "--algorithm=" + algorithm, "--stats=" + benchmark_case.stats_file});
+                cases.push_back(benchmark_case);
+            }
+        }
+    }
+
+    ParameterSweep sweep(this->executable, job_args, this->output_file + ".simulations.csv", this->num_workers,
+                         this->common_args);
+    int exit_code = sweep.run();
+
+    std::ofstream output(this->output_file, std::ios::trunc);
+    if (!output) {
+        std::cerr << "Cannot open " << this->output_file << std::endl;
+        return 1;
+    }
+    output << CSV_HEADER << std::endl;
+
+    auto &jobs = sweep.getJobs();
+    for (std::size_t i = 0; i < cases.size(); i++) {
+        // simulation statistics: number of tasks and number of processed events
+        unsigned long num_tasks = 0;
+        unsigned long num_events = 0;
+        std::ifstream stats(cases[i].stats_file);
+        if (!jobs[i].succeeded || !(stats >> num_tasks >> num_events)) {
+            continue;
+        }
+        stats.close();
+        std::remove(cases[i].stats_file.c_str());
+
+        output << cases[i].shape << "," << num_tasks << "," << cases[i].algorithm << "," << jobs[i].wall_time
+               << "," << jobs[i].max_rss << "," << num_events << ","
+               << (jobs[i].wall_time > 0 ? num_events / jobs[i].wall_time : 0) << std::endl;
+    }
+
+    std::cerr << "Benchmark report in " << this->output_file << std::endl;
+    return exit_code;
+}
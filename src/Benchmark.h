@@ -0,0 +1,46 @@
+/**
+ * Copyright (c) 2020-2021. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef ENERGY_AWARE_BENCHMARK_H
+#define ENERGY_AWARE_BENCHMARK_H
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief A scaling benchmark of the simulator itself, which simulates synthetic workflows of
+ *        increasing sizes with every scheduling algorithm, and reports the wall-clock time, peak
+ *        memory and event throughput of each simulation
+ */
+class Benchmark {
+public:
+    /** @brief Header of the benchmark report */
+    static const std::string CSV_HEADER;
+
+    Benchmark(std::string executable,
+              std::string platform_file,
+              std::string output_file,
+              std::vector<unsigned long> sizes,
+              std::vector<std::string> algorithms,
+              unsigned int num_workers = 1,
+              std::vector<std::string> common_args = {});
+
+    int run();
+
+private:
+    std::string executable;
+    std::string platform_file;
+    std::string output_file;
+    std::vector<unsigned long> sizes;
+    std::vector<std::string> algorithms;
+    unsigned int num_workers;
+    std::vector<std::string> common_args;
+};
+
+#endif //ENERGY_AWARE_BENCHMARK_H
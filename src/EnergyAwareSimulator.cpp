@@ -7,11 +7,21 @@
  * (at your option) any later version.
  */
 
+#include <fstream>
 #include <memory>
+#include <simgrid/s4u/Host.hpp>
+#include <sstream>
 #include <wrench-dev.h>
 
+#include "Benchmark.h"
 #include "EnergyAwareStandardJobScheduler.h"
 #include "GreedyWMS.h"
+#include "ParameterSweep.h"
+#include "PlatformGenerator.h"
+#include "Profiler.h"
+#include "ResultCache.h"
+#include "WorkflowGenerator.h"
+#include "WorkflowSnapshot.h"
 #include "cost_model/TraditionalPowerModel.h"
 #include "scheduling_algorithm/EnRealAlgorithm.h"
 #include "scheduling_algorithm/IOAwareAlgorithm.h"
@@ -20,37 +30,342 @@
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(EnergyAwareSimulator, "Log category for EnergyAwareSimulator");
 
+/**
+ * @brief Get the name of an --option=value command-line argument
+ *
+ * @param arg: the command-line argument
+ *
+ * @return the option name, or an empty string if the argument is not an option
+ */
+static std::string getOptionName(const std::string &arg) {
+    if (arg.rfind("--", 0) != 0) {
+        return "";
+    }
+    return arg.substr(2, arg.find('=') == std::string::npos ? std::string::npos : arg.find('=') - 2);
+}
+
+/**
+ * @brief Load a workflow from a JSON file, a workflow snapshot, or a synthetic workflow specification
+ *
+ * @param workflow_file: the workflow argument
+ *
+ * @return the workflow
+ */
+static wrench::Workflow *loadWorkflow(const std::string &workflow_file) {
+    if (WorkflowGenerator::isSyntheticWorkflow(workflow_file)) {
+        return WorkflowGenerator(workflow_file).generate();
+    } else if (WorkflowSnapshot::isSnapshot(workflow_file)) {
+        return WorkflowSnapshot::load(workflow_file);
+    }
+    return wrench::PegasusWorkflowParser::createWorkflowFromJSON(workflow_file, "1f");
+}
+
+/**
+ * @brief Print the result rows of a simulation, and write them to the --results CSV file (if any)
+ *
+ * @param label: the label that prefixes every row
+ * @param results: the result rows, without label
+ * @param options: the command-line options
+ *
+ * @return the simulator exit code
+ */
+static int emitResults(const std::string &label, const std::string &results,
+                       const std::map<std::string, std::string> &options) {
+    std::stringstream labeled_results;
+    std::istringstream rows(results);
+    std::string row;
+    while (std::getline(rows, row)) {
+        if (!row.empty()) {
+            labeled_results << label << "," << row << std::endl;
+        }
+    }
+    std::cerr << labeled_results.str();
+
+    if (options.find("results") != options.end()) {
+        std::ofstream results_file(options.at("results"), std::ios::trunc);
+        results_file << ParameterSweep::CSV_HEADER << std::endl << labeled_results.str();
+        if (!results_file) {
+            std::cerr << "Unable to write results to " << options.at("results") << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
+
 int main(int argc, char **argv) {
-    // create and initialize the simulation
-    wrench::Simulation simulation;
-    simulation.init(&argc, argv);
+    // separate positional arguments from --option=value arguments
+    std::vector<std::string> args;
+    std::map<std::string, std::string> options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto option_name = getOptionName(arg);
+        if (!option_name.empty()) {
+            auto separator = arg.find('=');
+            options[option_name] = (separator == std::string::npos ? "" : arg.substr(separator + 1));
+        } else {
+            args.push_back(arg);
+        }
+    }
+
+    // parameter sweep: each simulation runs in its own worker process
+    if (options.find("sweep") != options.end()) {
+        std::vector<std::string> common_args;
+        for (int i = 1; i < argc; i++) {
+            auto option_name = getOptionName(argv[i]);
+            if (option_name != "sweep" && option_name != "jobs" && option_name != "output") {
+                common_args.emplace_back(argv[i]);
+            }
+        }
+        std::string output_file = (options.find("output") != options.end() ? options.at("output") : "results.csv");
+        unsigned int num_workers = (options.find("jobs") != options.end() ? std::stoul(options.at("jobs")) : 0);
+        return ParameterSweep(argv[0], options.at("sweep"), output_file, num_workers, common_args).run();
+    }
+
+    // simulator benchmark: synthetic workflows of increasing sizes, simulated with every algorithm
+    if (options.find("benchmark") != options.end()) {
+        std::vector<std::string> common_args;
+        for (int i = 1; i < argc; i++) {
+            auto option_name = getOptionName(argv[i]);
+            if (option_name != "benchmark" && option_name != "benchmark-sizes" && option_name != "jobs" &&
+                option_name != "output") {
+                common_args.emplace_back(argv[i]);
+            }
+        }
+        std::vector<unsigned long> sizes;
+        std::istringstream size_list(options.find("benchmark-sizes") != options.end() ? options.at("benchmark-sizes")
+                                                                                      : "1000,10000,100000,1000000");
+        std::string size;
+        while (std::getline(size_list, size, ',')) {
+            sizes.push_back(std::stoul(size));
+        }
+        std::string output_file = (options.find("output") != options.end() ? options.at("output") : "benchmark.csv");
+        unsigned int num_workers = (options.find("jobs") != options.end() ? std::stoul(options.at("jobs")) : 1);
+        return Benchmark(argv[0], options.at("benchmark"), output_file, sizes,
+                         {"SPSS-EB", "EnReal", "IOAware", "IOAwareBalance"}, num_workers, common_args).run();
+    }
+
+    // workflow conversion: parse a JSON workflow once and save it as a binary snapshot
+    if (options.find("convert-workflow") != options.end()) {
+        if (args.size() != 1) {
+            std::cerr << "Usage: " << argv[0] << " --convert-workflow=<snapshot file> <JSON workflow file>" << std::endl;
+            exit(1);
+        }
+        try {
+            auto workflow = loadWorkflow(args[0]);
+            WorkflowSnapshot::write(workflow, options.at("convert-workflow"));
+            std::cerr << "Wrote a snapshot of " << workflow->getNumberOfTasks() << " tasks to "
+                      << options.at("convert-workflow") << std::endl;
+            delete workflow;
+        } catch (std::exception &e) {
+            std::cerr << "Unable to convert workflow: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    // platform generation: write a platform with any number of identical worker hosts
+    if (options.find("generate-platform") != options.end()) {
+        try {
+            PlatformGenerator generator(
+                    std::stoul(options.find("hosts") != options.end() ? options.at("hosts") : "4"),
+                    std::stoul(options.find("cores") != options.end() ? options.at("cores") : "12"),
+                    (options.find("wattage-per-state") != options.end() ? options.at("wattage-per-state")
+                                                                         : "98.080000:112.727273:200.000000"),
+                    (options.find("watt-off") != options.end() ? options.at("watt-off") : "10"),
+                    (options.find("disk-bandwidth") != options.end() ? options.at("disk-bandwidth") : "100MBps"),
+                    std::stoul(options.find("clusters") != options.end() ? options.at("clusters") : "1"));
+            generator.write(options.at("generate-platform"));
+        } catch (std::exception &e) {
+            std::cerr << "Unable to generate platform: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
 
     // check to make sure there are the right number of arguments
-    if (argc < 3) {
+    if (args.size() < 2) {
         std::cerr << "WRENCH Pegasus WMS Simulator" << std::endl;
         std::cerr << "Usage: " << argv[0]
-                  << " <xml platform file> <JSON workflow file>"
-                  << std::endl;
+                  << " <xml platform file> <JSON workflow file|workflow snapshot|synthetic:<shape>:<tasks>[:<seed>]> [label]"
+                  << " [--algorithm=SPSS-EB|EnReal|IOAware|IOAwareBalance]"
+                  << " [--energy-integration=sampling|adaptive|analytic] [--energy-trace=<binary trace file>]"
+                  << " [--measurement-period=<seconds>] [--max-sampling-interval=<seconds>]"
+                  << " [--event-coalescing] [--event-coalescing-window=<seconds>]"
+                  << " [--task-clustering=none|horizontal|vertical] [--cluster-size=<tasks per job>]"
+                  << " [--vm-cores=<cores per VM>|adaptive]"
+                  << " [--vm-keep-alive=<seconds>] [--max-idle-vms-per-host=<number of VMs>]"
+                  << " [--results=<CSV file>] [--cache-dir=<result cache directory>] [--stats=<file>]"
+                  << " [--profile]" << std::endl;
+        std::cerr << "       " << argv[0]
+                  << " --sweep=<job matrix file> [--jobs=<number of workers>] [--output=<CSV file>]"
+                  << " [options applied to every job]" << std::endl;
+        std::cerr << "       (each line of the job matrix holds the arguments of one simulation)" << std::endl;
+        std::cerr << "       (synthetic workflow shapes: fork-join, montage, epigenomics)" << std::endl;
+        std::cerr << "       " << argv[0] << " --convert-workflow=<snapshot file> <JSON workflow file>" << std::endl;
+        std::cerr << "       " << argv[0]
+                  << " --benchmark=<xml platform file> [--benchmark-sizes=<number of tasks>,...]"
+                  << " [--jobs=<number of workers>] [--output=<CSV file>]" << std::endl;
+        std::cerr << "       " << argv[0]
+                  << " --generate-platform=<xml platform file> [--hosts=<number of workers>] [--cores=<cores per worker>]"
+                  << " [--wattage-per-state=<idle:one core:all cores>] [--watt-off=<watts>]"
+                  << " [--disk-bandwidth=<bandwidth>] [--clusters=<number of clusters>]" << std::endl;
         exit(1);
     }
 
     //create the platform file and dax file from command line args
-    char *platform_file = argv[1];
-    char *workflow_file = argv[2];
+    const char *platform_file = args[0].c_str();
+    const char *workflow_file = args[1].c_str();
+    std::string label = (args.size() > 2 ? args[2] : args[1]);
+
+    // scheduling algorithm
+    std::string algorithm = (options.find("algorithm") != options.end() ? options.at("algorithm") : "EnReal");
+    if (algorithm != "SPSS-EB" && algorithm != "EnReal" && algorithm != "IOAware" && algorithm != "IOAwareBalance") {
+        std::cerr << "Unknown scheduling algorithm: " << algorithm << std::endl;
+        exit(1);
+    }
+
+    // energy integration mode
+    auto integration_mode = PowerMeter::SAMPLING;
+    if (options.find("energy-integration") != options.end()) {
+        if (options.at("energy-integration") == "analytic") {
+            integration_mode = PowerMeter::ANALYTIC;
+        } else if (options.at("energy-integration") == "adaptive") {
+            integration_mode = PowerMeter::ADAPTIVE_SAMPLING;
+        } else if (options.at("energy-integration") != "sampling") {
+            std::cerr << "Unknown energy integration mode: " << options.at("energy-integration") << std::endl;
+            exit(1);
+        }
+    }
+
+    // power meter sampling
+    double measurement_period = 1.0;
+    double max_sampling_interval = 60.0;
+    if (options.find("measurement-period") != options.end()) {
+        measurement_period = std::stod(options.at("measurement-period"));
+    }
+    if (options.find("max-sampling-interval") != options.end()) {
+        max_sampling_interval = std::stod(options.at("max-sampling-interval"));
+    }
+    if (measurement_period < 1) {
+        std::cerr << "Invalid measurement period: " << measurement_period << std::endl;
+        exit(1);
+    }
+    if (integration_mode == PowerMeter::ADAPTIVE_SAMPLING && max_sampling_interval < measurement_period) {
+        std::cerr << "Invalid maximum sampling interval: " << max_sampling_interval << std::endl;
+        exit(1);
+    }
+
+    // task clustering into multi-task standard jobs
+    auto task_clustering = EnergyAwareStandardJobScheduler::NO_CLUSTERING;
+    if (options.find("task-clustering") != options.end()) {
+        if (options.at("task-clustering") == "horizontal") {
+            task_clustering = EnergyAwareStandardJobScheduler::HORIZONTAL;
+        } else if (options.at("task-clustering") == "vertical") {
+            task_clustering = EnergyAwareStandardJobScheduler::VERTICAL;
+        } else if (options.at("task-clustering") != "none") {
+            std::cerr << "Unknown task clustering: " << options.at("task-clustering") << std::endl;
+            exit(1);
+        }
+    }
+    unsigned long cluster_size = (options.find("cluster-size") != options.end()
+                                  ? std::stoul(options.at("cluster-size")) : 4);
+    if (cluster_size == 0) {
+        std::cerr << "Invalid cluster size: " << cluster_size << std::endl;
+        exit(1);
+    }
+
+    // number of cores of the VMs
+    unsigned long vm_cores = 1;
+    if (options.find("vm-cores") != options.end()) {
+        vm_cores = (options.at("vm-cores") == "adaptive" ? 0 : std::stoul(options.at("vm-cores")));
+        if (vm_cores == 0 && options.at("vm-cores") != "adaptive") {
+            std::cerr << "Invalid number of cores per VM: " << options.at("vm-cores") << std::endl;
+            exit(1);
+        }
+    }
+
+    // idle VMs kept warm
+    double vm_keep_alive = 0;
+    unsigned long max_idle_vms_per_host = 1;
+    if (options.find("vm-keep-alive") != options.end()) {
+        vm_keep_alive = std::stod(options.at("vm-keep-alive"));
+        if (vm_keep_alive < 0) {
+            std::cerr << "Invalid VM keep-alive timeout: " << vm_keep_alive << std::endl;
+            exit(1);
+        }
+    }
+    if (options.find("max-idle-vms-per-host") != options.end()) {
+        max_idle_vms_per_host = std::stoul(options.at("max-idle-vms-per-host"));
+    }
+
+    // events processed together before a scheduling round
+    bool event_coalescing = (options.find("event-coalescing") != options.end());
+    double event_coalescing_window = 0;
+    if (options.find("event-coalescing-window") != options.end()) {
+        event_coalescing = true;
+        event_coalescing_window = std::stod(options.at("event-coalescing-window"));
+        if (event_coalescing_window < 0) {
+            std::cerr << "Invalid event coalescing window: " << event_coalescing_window << std::endl;
+            exit(1);
+        }
+    }
+
+    // self-profiling of the simulator hot paths
+    if (options.find("profile") != options.end()) {
+        Profiler::enable();
+    }
+
+    // result cache, keyed by the simulation inputs (the energy trace, statistics and profile are not cached, so
+    // they bypass the cache)
+    std::unique_ptr<ResultCache> result_cache;
+    std::string cache_key;
+    if (options.find("cache-dir") != options.end() && options.find("energy-trace") == options.end() &&
+        options.find("stats") == options.end() && options.find("profile") == options.end()) {
+        std::map<std::string, std::string> parameters;
+        for (auto &option : options) {
+            if (option.first != "results" && option.first != "cache-dir" && option.first.rfind("log", 0) != 0 &&
+                option.first.rfind("wrench-", 0) != 0) {
+                parameters.insert(option);
+            }
+        }
+        parameters["algorithm"] = algorithm;
+        parameters["cost-model"] = "traditional";
+
+        // synthetic workflows are fully described by their specification
+        std::vector<std::string> input_files = {platform_file};
+        if (WorkflowGenerator::isSyntheticWorkflow(workflow_file)) {
+            parameters["workflow"] = workflow_file;
+        } else {
+            input_files.emplace_back(workflow_file);
+        }
+
+        result_cache = std::make_unique<ResultCache>(options.at("cache-dir"));
+        cache_key = ResultCache::computeKey(input_files, parameters);
+
+        std::string cached_results;
+        if (result_cache->lookup(cache_key, cached_results)) {
+            std::cerr << "Results found in cache (" << cache_key << ")" << std::endl;
+            return emitResults(label, cached_results, options);
+        }
+    }
+
+    // create and initialize the simulation
+    wrench::Simulation simulation;
+    simulation.init(&argc, argv);
 
     // instantiating SimGrid platform
     WRENCH_INFO("Instantiating SimGrid platform from: %s", platform_file);
     simulation.instantiatePlatform(platform_file);
 
-    // loading the workflow from the JSON file
+    // loading the workflow from the JSON file, or from a pre-parsed snapshot
     WRENCH_INFO("Loading workflow from: %s", workflow_file);
-    wrench::Workflow *workflow;
-    workflow = wrench::PegasusWorkflowParser::createWorkflowFromJSON(workflow_file, "1f");
+    wrench::Workflow *workflow = loadWorkflow(workflow_file);
 
     WRENCH_INFO("The workflow has %ld tasks", workflow->getNumberOfTasks());
     std::cerr << "Total Number of Workflow Tasks: " << workflow->getNumberOfTasks() << std::endl;
 
     std::string wms_host = "master";
+    std::string storage_host = "data_server";
 
     // file registry service
     WRENCH_INFO("Instantiating a FileRegistryService on: %s", wms_host.c_str());
@@ -59,31 +374,77 @@ int main(int argc, char **argv) {
 
     // compute services
     std::set<std::shared_ptr<wrench::ComputeService>> compute_services;
-    std::vector<std::string> hosts{"worker1", "worker2", "worker3", "worker4"};
-    auto cloud_service = simulation.add(new wrench::CloudComputeService(wms_host, hosts, {"/"}, {}, {
-            {wrench::CloudComputeServiceMessagePayload::START_VM_REQUEST_MESSAGE_PAYLOAD,    1024},
-            {wrench::CloudComputeServiceMessagePayload::SHUTDOWN_VM_REQUEST_MESSAGE_PAYLOAD, 1024},
-    }));
-    compute_services.insert(cloud_service);
+    // every platform host other than the WMS and storage hosts is a worker
+    std::vector<std::string> hosts;
+    for (auto &host : simulation.getHostnameList()) {
+        if (host != wms_host && host != storage_host) {
+            hosts.push_back(host);
+        }
+    }
+    if (hosts.empty()) {
+        std::cerr << "The platform has no worker host" << std::endl;
+        return 1;
+    }
+
+    // one cloud service per group of workers sharing the same "cluster" host property
+    std::map<std::string, std::vector<std::string>> hosts_per_cluster;
+    for (auto &host : hosts) {
+        auto cluster = simgrid::s4u::Host::by_name(host)->get_property("cluster");
+        hosts_per_cluster[cluster ? cluster : ""].push_back(host);
+    }
+    std::vector<std::shared_ptr<wrench::CloudComputeService>> cloud_services;
+    for (auto &cluster : hosts_per_cluster) {
+        WRENCH_INFO("Instantiating a CloudComputeService on %ld hosts of cluster '%s'",
+                    cluster.second.size(), cluster.first.c_str());
+        cloud_services.push_back(simulation.add(new wrench::CloudComputeService(wms_host, cluster.second, {"/"}, {}, {
+                {wrench::CloudComputeServiceMessagePayload::START_VM_REQUEST_MESSAGE_PAYLOAD,    1024},
+                {wrench::CloudComputeServiceMessagePayload::SHUTDOWN_VM_REQUEST_MESSAGE_PAYLOAD, 1024},
+        })));
+        compute_services.insert(cloud_services.back());
+    }
 
     // storage services
-    std::string storage_host = "data_server";
     std::shared_ptr<wrench::StorageService> storage_service = simulation.add(
             new wrench::SimpleStorageService(storage_host, {"/"}));
 
-    // scheduling algorithm
-//    auto scheduling_algorithm = std::make_unique<SPSSEBAlgorithm>(
-//    auto scheduling_algorithm = std::make_unique<IOAwareAlgorithm>(
-//    auto scheduling_algorithm = std::make_unique<IOAwareBalanceAlgorithm>(
-    auto scheduling_algorithm = std::make_unique<EnRealAlgorithm>(
-            cloud_service,
-            std::make_unique<TraditionalPowerModel>(cloud_service));
+    // scheduling algorithms, one per cloud service (cloud_services is not resized from here on, since the
+    // algorithms keep a reference to their cloud service)
+    std::vector<std::unique_ptr<SchedulingAlgorithm>> scheduling_algorithms;
+    for (auto &cloud_service : cloud_services) {
+        std::unique_ptr<SchedulingAlgorithm> scheduling_algorithm;
+        if (algorithm == "SPSS-EB") {
+            scheduling_algorithm = std::make_unique<SPSSEBAlgorithm>(
+                    cloud_service, std::make_unique<TraditionalPowerModel>(cloud_service));
+        } else if (algorithm == "IOAware") {
+            scheduling_algorithm = std::make_unique<IOAwareAlgorithm>(
+                    cloud_service, std::make_unique<TraditionalPowerModel>(cloud_service));
+        } else if (algorithm == "IOAwareBalance") {
+            scheduling_algorithm = std::make_unique<IOAwareBalanceAlgorithm>(
+                    cloud_service, std::make_unique<TraditionalPowerModel>(cloud_service));
+        } else {
+            scheduling_algorithm = std::make_unique<EnRealAlgorithm>(
+                    cloud_service, std::make_unique<TraditionalPowerModel>(cloud_service));
+        }
+        scheduling_algorithm->setVMNumCores(vm_cores);
+        scheduling_algorithms.push_back(std::move(scheduling_algorithm));
+    }
+
+    // power measurements store, only kept if the trace should be dumped
+    std::shared_ptr<EnergyTraceStore> energy_trace = nullptr;
+    if (options.find("energy-trace") != options.end()) {
+        energy_trace = std::make_shared<EnergyTraceStore>();
+    }
 
     // instantiate the wms
+    auto scheduler = std::make_unique<EnergyAwareStandardJobScheduler>(
+            storage_service, std::move(scheduling_algorithms), task_clustering, cluster_size,
+            VMPool(vm_keep_alive, max_idle_vms_per_host));
+    auto vm_pool = &scheduler->getVMPool();
     auto wms = simulation.add(
-            new GreedyWMS(std::make_unique<EnergyAwareStandardJobScheduler>(
-                    storage_service, std::move(scheduling_algorithm)),
-                          compute_services, {storage_service}, wms_host));
+            new GreedyWMS(std::move(scheduler),
+                          compute_services, {storage_service}, wms_host, energy_trace, integration_mode,
+                          measurement_period, max_sampling_interval, event_coalescing,
+                          event_coalescing_window));
 
     wms->addWorkflow(workflow);
 
@@ -99,7 +460,7 @@ int main(int argc, char **argv) {
         simulation.launch();
     } catch (std::runtime_error &e) {
         std::cerr << "Exception: " << e.what() << std::endl;
-        return 0;
+        return 1;
     }
 
     WRENCH_INFO("Simulation done!");
@@ -107,64 +468,76 @@ int main(int argc, char **argv) {
     // json output file
     simulation.getOutput().dumpUnifiedJSON(workflow, "tmp.json");
 
-    // statistics
-    auto power_trace = simulation.getOutput().getTrace<wrench::SimulationTimestampEnergyConsumption>();
-    double previous_traditional_date = 0;
-    double previous_pairwise_date = 0;
-    double previous_unpaired_date = 0;
-    std::map<std::string, double> workers_traditional_power;
-    std::map<std::string, double> workers_pairwise_power;
-    std::map<std::string, double> workers_unpaired_power;
-
-    for (auto &host : hosts) {
-        workers_traditional_power.insert(std::pair<std::string, double>(host, 0));
-        workers_pairwise_power.insert(std::pair<std::string, double>(host, 0));
-        workers_unpaired_power.insert(std::pair<std::string, double>(host, 0));
-    }
-    for (auto measurement : power_trace) {
-        auto key = measurement->getContent()->getHostname();
-        auto model = key.substr(0, key.find("__"));
-        auto hostname = key.substr(key.find("__") + 2, key.size());
-
-        if (model == "traditional") {
-            auto diff = (measurement->getContent()->getDate() - previous_traditional_date);
-            workers_traditional_power.at(hostname) += measurement->getContent()->getConsumption() *
-                                                      ((diff > 0 ? diff : 1) / 3600.0);
-            previous_traditional_date = measurement->getContent()->getDate();
-
-        } else if (model == "pairwise") {
-            auto diff = (measurement->getContent()->getDate() - previous_pairwise_date);
-            workers_pairwise_power.at(hostname) += measurement->getContent()->getConsumption() *
-                                                   ((diff > 0 ? diff : 1) / 3600.0);
-            previous_pairwise_date = measurement->getContent()->getDate();
-
-        } else if (model == "unpaired") {
-            auto diff = (measurement->getContent()->getDate() - previous_unpaired_date);
-            workers_unpaired_power.at(hostname) += measurement->getContent()->getConsumption() *
-                                                   ((diff > 0 ? diff : 1) / 3600.0);
-            previous_unpaired_date = measurement->getContent()->getDate();
-        }
+    // binary energy trace
+    if (energy_trace) {
+        Profiler::Scope profiler_scope(Profiler::TRACE_DUMP);
+        energy_trace->dumpBinary(options.at("energy-trace"));
     }
 
+    // statistics
     double total_traditional_energy = 0;
     double total_pairwise_energy = 0;
     double total_unpaired_energy = 0;
+    {
+        Profiler::Scope profiler_scope(Profiler::ENERGY_AGGREGATION);
+        std::map<std::string, double> workers_traditional_power;
+        std::map<std::string, double> workers_pairwise_power;
+        std::map<std::string, double> workers_unpaired_power;
 
-    for (auto &host : hosts) {
-        total_traditional_energy += workers_traditional_power.at(host);
-        total_pairwise_energy += workers_pairwise_power.at(host);
-        total_unpaired_energy += workers_unpaired_power.at(host);
+        for (auto &host : hosts) {
+            workers_traditional_power.insert(std::pair<std::string, double>(host, 0));
+            workers_pairwise_power.insert(std::pair<std::string, double>(host, 0));
+            workers_unpaired_power.insert(std::pair<std::string, double>(host, 0));
+        }
+        // energy is accumulated online by the power meters, each one metering the hosts of a cloud service
+        for (auto &power_meter : wms->getPowerMeters()) {
+            for (auto &host : power_meter->getHostnames()) {
+                workers_traditional_power.at(host) +=
+                        power_meter->getEnergyConsumption(PowerMeter::TRADITIONAL, host);
+                workers_pairwise_power.at(host) += power_meter->getEnergyConsumption(PowerMeter::PAIRWISE, host);
+                workers_unpaired_power.at(host) += power_meter->getEnergyConsumption(PowerMeter::UNPAIRED, host);
+            }
+        }
+
+        for (auto &host : hosts) {
+            total_traditional_energy += workers_traditional_power.at(host);
+            total_pairwise_energy += workers_pairwise_power.at(host);
+            total_unpaired_energy += workers_unpaired_power.at(host);
+        }
     }
     std::cerr << "Workflow Makespan (s): " << wrench::Simulation::getCurrentSimulatedDate() << std::endl;
     std::cerr << "Total Traditional Energy (Wh): " << total_traditional_energy << std::endl;
     std::cerr << "Total Pairwise Energy (Wh): " << total_pairwise_energy << std::endl;
     std::cerr << "Total Unpaired Energy (Wh): " << total_unpaired_energy << std::endl;
+    if (vm_pool->isEnabled()) {
+        std::cerr << "VM Pool Hits/Misses: " << vm_pool->getNumHits() << "/" << vm_pool->getNumMisses() << std::endl;
+    }
     std::cerr << std::endl;
-    std::cerr << argv[3] << "," << workflow->getNumberOfTasks() << ",EnReal,traditional,"
-              << total_traditional_energy << "," << wrench::Simulation::getCurrentSimulatedDate() << std::endl;
-    std::cerr << argv[3] << "," << workflow->getNumberOfTasks() << ",EnReal,pairwise,"
-              << total_pairwise_energy << "," << wrench::Simulation::getCurrentSimulatedDate() << std::endl;
-    std::cerr << argv[3] << "," << workflow->getNumberOfTasks() << ",EnReal,unpaired,"
-              << total_unpaired_energy << "," << wrench::Simulation::getCurrentSimulatedDate() << std::endl;
-    return 0;
+
+    if (Profiler::isEnabled()) {
+        Profiler::report(std::cerr);
+        std::cerr << std::endl;
+    }
+
+    // one result row per power model
+    std::stringstream results;
+    std::vector<std::pair<std::string, double>> total_energy = {
+            {PowerMeter::getPowerModelName(PowerMeter::TRADITIONAL), total_traditional_energy},
+            {PowerMeter::getPowerModelName(PowerMeter::PAIRWISE),    total_pairwise_energy},
+            {PowerMeter::getPowerModelName(PowerMeter::UNPAIRED),    total_unpaired_energy}};
+    for (auto &model_energy : total_energy) {
+        results << workflow->getNumberOfTasks() << "," << algorithm << "," << model_energy.first << ","
+                << model_energy.second << "," << wrench::Simulation::getCurrentSimulatedDate() << std::endl;
+    }
+
+    if (result_cache) {
+        result_cache->store(cache_key, results.str());
+    }
+
+    // simulator statistics (number of tasks and of processed workflow execution events)
+    if (options.find("stats") != options.end()) {
+        std::ofstream stats_file(options.at("stats"), std::ios::trunc);
+        stats_file << workflow->getNumberOfTasks() << " " << wms->getNumProcessedEvents() << std::endl;
+    }
+    return emitResults(label, results.str(), options);
 }
@@ -8,7 +8,12 @@
  */
 
 #include "EnergyAwareStandardJobScheduler.h"
+#include "Profiler.h"
 
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <queue>
 #include <utility>
 
 WRENCH_LOG_CATEGORY(energy_aware_scheduler, "Log category for EnergyAwareStandardJobScheduler");
@@ -17,18 +22,40 @@ WRENCH_LOG_CATEGORY(energy_aware_scheduler, "Log category for EnergyAwareStandar
  * @brief Constructor, which calls the super constructor
  *
  * @param storage_service: default storage service available for the scheduler
+ * @param scheduling_algorithms: the algorithms that sort tasks and select their VMs, one per cloud service
+ * @param task_clustering: how ready tasks are bundled into standard jobs
+ * @param cluster_size: maximum number of tasks per standard job
+ * @param vm_pool: the pool that keeps idle VMs warm (disabled by default)
+ *
+ * @throw std::invalid_argument
  */
 EnergyAwareStandardJobScheduler::EnergyAwareStandardJobScheduler(
         std::shared_ptr<wrench::StorageService> storage_service,
-        std::unique_ptr<SchedulingAlgorithm> scheduling_algorithm) :
+        std::vector<std::unique_ptr<SchedulingAlgorithm>> scheduling_algorithms,
+        TaskClustering task_clustering,
+        unsigned long cluster_size,
+        VMPool vm_pool) :
         default_storage_service(std::move(storage_service)),
-        scheduling_algorithm(std::move(scheduling_algorithm)) {
+        scheduling_algorithms(std::move(scheduling_algorithms)),
+        task_clustering(task_clustering),
+        cluster_size(cluster_size),
+        vm_pool(std::move(vm_pool)) {
+    if (this->scheduling_algorithms.empty()) {
+        throw std::invalid_argument(
+                "EnergyAwareStandardJobScheduler::EnergyAwareStandardJobScheduler(): at least one scheduling algorithm is required");
+    }
+    if (this->cluster_size == 0) {
+        throw std::invalid_argument(
+                "EnergyAwareStandardJobScheduler::EnergyAwareStandardJobScheduler(): cluster size must be at least 1");
+    }
     this->unscheduled_tasks = 0;
 }
 
 /**
  * @brief A method that schedules tasks (as part of standard jobs), according to whatever decision algorithm
- *        it implements, over a set of compute services
+ *        it implements, over a set of compute services. Cloud services are tried in turn, from the one with
+ *        the lowest energy cost among those with idle cores, each one receiving the tasks that the previous
+ *        ones could not place.
  * @param compute_services: the set of compute services
  * @param tasks: the set of tasks to be executed
  */
@@ -38,68 +65,349 @@ void EnergyAwareStandardJobScheduler::scheduleTasks(
     // If nothing to do, return;
     if (compute_services.empty() or tasks.empty()) {
         return;
-    } else if (compute_services.size() > 1) {
-        throw std::runtime_error("This Energy-Aware Cloud Scheduler can only handle a single compute service");
     }
 
+    Profiler::Scope profiler_scope(Profiler::SCHEDULE_TASKS);
     WRENCH_INFO("There are %ld ready tasks to schedule", tasks.size());
     this->unscheduled_tasks = tasks.size();
 
-    // Sort tasks
-    auto sorted_tasks = this->scheduling_algorithm->sortTasks(tasks);
+    // rank cloud services by available capacity and energy cost
+    std::vector<std::size_t> service_order(this->scheduling_algorithms.size());
+    std::vector<unsigned long> idle_cores(this->scheduling_algorithms.size());
+    {
+        Profiler::Pause profiler_pause;
+        if (this->watts_per_core.empty()) {
+            this->computeWattsPerCore();
+        }
+        for (std::size_t s = 0; s < service_order.size(); s++) {
+            service_order[s] = s;
+            idle_cores[s] = (service_order.size() > 1
+                             ? this->scheduling_algorithms[s]->getCloudService()->getTotalNumIdleCores() : 0);
+        }
+    }
+    std::stable_sort(service_order.begin(), service_order.end(), [this, &idle_cores](std::size_t s1, std::size_t s2) {
+        if ((idle_cores[s1] > 0) != (idle_cores[s2] > 0)) {
+            return idle_cores[s1] > 0;
+        } else if (this->watts_per_core[s1] != this->watts_per_core[s2]) {
+            return this->watts_per_core[s1] < this->watts_per_core[s2];
+        }
+        return idle_cores[s1] > idle_cores[s2];
+    });
+
+    auto remaining_tasks = tasks;
+    for (auto s : service_order) {
+        if (remaining_tasks.empty()) {
+            break;
+        }
+        remaining_tasks = this->scheduleTasksOnService(*this->scheduling_algorithms[s], remaining_tasks);
+    }
+}
+
+/**
+ * @brief Schedule tasks on the cloud service of a scheduling algorithm
+ *
+ * @param scheduling_algorithm: the scheduling algorithm
+ * @param tasks: the tasks to be executed
+ *
+ * @return the tasks that could not be scheduled
+ */
+std::vector<wrench::WorkflowTask *> EnergyAwareStandardJobScheduler::scheduleTasksOnService(
+        SchedulingAlgorithm &scheduling_algorithm, const std::vector<wrench::WorkflowTask *> &tasks) {
+    auto cloud_service = scheduling_algorithm.getCloudService();
+    std::vector<wrench::WorkflowTask *> failed_tasks;
 
-    // obtaining cloud service
-    auto cloud_service = std::dynamic_pointer_cast<wrench::CloudComputeService>(*compute_services.begin());
-    if (cloud_service == nullptr) {
-        throw std::runtime_error("This Energy-Aware Cloud Scheduler can only handle a cloud service");
+    // Sort tasks
+    std::vector<wrench::WorkflowTask *> sorted_tasks;
+    {
+        Profiler::Scope sort_scope(Profiler::SORT_TASKS);
+        sorted_tasks = scheduling_algorithm.sortTasks(tasks);
     }
 
-    // attempting to schedule tasks
-    for (auto const &task : sorted_tasks) {
-        auto vm_name = this->scheduling_algorithm->scheduleTask(task);
+    // attempting to schedule tasks, one standard job per cluster (the VM is selected for the first task)
+    auto clusters = this->clusterTasks(scheduling_algorithm, sorted_tasks);
+    for (std::size_t c = 0; c < clusters.size(); c++) {
+        auto const &cluster = clusters[c];
+        std::string vm_name;
+        auto num_vm_starts = scheduling_algorithm.getNumVMStarts();
+        {
+            Profiler::Scope schedule_scope(Profiler::SCHEDULE_TASK);
+            // adaptive VM sizing packs the jobs that are still pending in this round on a multi-core VM
+            scheduling_algorithm.setNumPendingTasks(clusters.size() - c);
+            vm_name = scheduling_algorithm.scheduleTask(cluster.front());
+        }
 
-        if (!vm_name.empty()) {
-            // finding the file locations
-            std::map<wrench::WorkflowFile *, std::shared_ptr<wrench::FileLocation>> file_locations;
+        if (vm_name.empty()) {
+            // the descendants merged by vertical clustering are not ready yet
+            for (auto const &task : cluster) {
+                if (task->getState() == wrench::WorkflowTask::State::READY) {
+                    failed_tasks.push_back(task);
+                }
+            }
+            continue;
+        }
+
+        // finding the file locations, which all share the interned location of the default storage service
+        auto file_location = this->getFileLocation(this->default_storage_service);
+        std::map<wrench::WorkflowFile *, std::shared_ptr<wrench::FileLocation>> file_locations;
+        for (auto const &task : cluster) {
             for (auto f : task->getInputFiles()) {
-                file_locations[f] = wrench::FileLocation::LOCATION(this->default_storage_service);
+                file_locations.emplace(f, file_location);
             }
             for (auto f : task->getOutputFiles()) {
-                file_locations[f] = wrench::FileLocation::LOCATION(this->default_storage_service);
+                file_locations.emplace(f, file_location);
             }
+        }
 
-            // creating job for execution
-            std::shared_ptr<wrench::WorkflowJob> job =
-                    (std::shared_ptr<wrench::WorkflowJob>) this->getJobManager()->createStandardJob(task,
-                                                                                                    file_locations);
+        // creating job for execution (the job manager takes the file locations by value)
+        std::shared_ptr<wrench::WorkflowJob> job =
+                (std::shared_ptr<wrench::WorkflowJob>) this->getJobManager()->createStandardJob(
+                        cluster, std::move(file_locations));
 
-            WRENCH_INFO("Scheduling task: %s", task->getID().c_str());
+        std::string vm_pm;
+        {
+            Profiler::Pause profiler_pause;
             auto vm_cs = cloud_service->getVMComputeService(vm_name);
             this->getJobManager()->submitJob(job, vm_cs);
+            vm_pm = cloud_service->getVMPhysicalHostname(vm_name);
+        }
+        this->vm_algorithms[vm_name] = &scheduling_algorithm;
+        if (this->vm_pool.isEnabled()) {
+            // a pool miss is a job for which a VM had to be created or restarted, and a hit is a job dispatched
+            // to a VM kept warm by the pool (jobs dispatched to busy VMs are neither)
+            if (scheduling_algorithm.getNumVMStarts() > num_vm_starts) {
+                this->vm_pool.notifyVMStart();
+            } else {
+                this->vm_pool.acquire(vm_name);
+            }
+        }
+
+        // notify the power meters of the host
+        auto meters_it = this->power_meters_per_host.find(vm_pm);
+        for (auto const &task : cluster) {
+            WRENCH_INFO("Scheduling task: %s", task->getID().c_str());
+            for (auto const &algorithm : this->scheduling_algorithms) {
+                algorithm->notifyTaskScheduled(task);
+            }
             this->tasks_vm_map.insert(std::pair<wrench::WorkflowTask *, std::string>(task, vm_name));
-            this->unscheduled_tasks--;
+            scheduling_algorithm.notifyTaskStart(vm_name);
+            if (meters_it != this->power_meters_per_host.end()) {
+                for (auto &power_meter : meters_it->second) {
+                    power_meter->notifyTaskStart(task, vm_pm);
+                }
+            }
+        }
+        // only the first task of a vertical cluster is ready, hence counted in the unscheduled tasks
+        this->unscheduled_tasks -= (this->task_clustering == VERTICAL ? 1 : (int) cluster.size());
+    }
+    return failed_tasks;
+}
+
+/**
+ * @brief Compute the average peak power drawn per core by the hosts of each cloud service, which is the
+ *        energy cost used to rank the services
+ */
+void EnergyAwareStandardJobScheduler::computeWattsPerCore() {
+    for (auto const &scheduling_algorithm : this->scheduling_algorithms) {
+        double watts = 0;
+        auto num_cores_host = scheduling_algorithm->getCloudService()->getPerHostNumCores();
+        for (auto const &host : num_cores_host) {
+            watts += wrench::Simulation::getMaxPowerConsumption(host.first) / (double) host.second;
+        }
+        this->watts_per_core.push_back(num_cores_host.empty() ? 0 : watts / (double) num_cores_host.size());
+    }
+}
+
+/**
+ * @brief Get the location of the mount point of a storage service, created once per storage service
+ *
+ * @param storage_service: the storage service
+ *
+ * @return the file location
+ */
+std::shared_ptr<wrench::FileLocation> EnergyAwareStandardJobScheduler::getFileLocation(
+        const std::shared_ptr<wrench::StorageService> &storage_service) {
+    auto &file_location = this->file_locations_per_service[storage_service.get()];
+    if (!file_location) {
+        file_location = wrench::FileLocation::LOCATION(storage_service);
+    }
+    return file_location;
+}
+
+/**
+ * @brief Bundle sorted ready tasks into clusters, each one executed as a single standard job on the VM selected
+ *        for its first task. Horizontal clusters only bundle tasks planned on the same host; vertical clusters
+ *        bundle descendants that are not ready, hence not planned yet, and run on the host of their first task
+ *
+ * @param scheduling_algorithm: the scheduling algorithm, which may have planned the host of each task
+ * @param tasks: the sorted ready tasks
+ *
+ * @return the clusters, ordered by the position of their first task in the sorted tasks
+ */
+std::vector<std::vector<wrench::WorkflowTask *>> EnergyAwareStandardJobScheduler::clusterTasks(
+        const SchedulingAlgorithm &scheduling_algorithm, const std::vector<wrench::WorkflowTask *> &tasks) {
+    std::vector<std::vector<wrench::WorkflowTask *>> clusters;
+
+    if (this->task_clustering == NO_CLUSTERING || this->cluster_size == 1) {
+        for (auto task : tasks) {
+            clusters.push_back({task});
+        }
+
+    } else if (this->task_clustering == VERTICAL) {
+        // merge each task with the chain of descendants that only depend on the previous task of the chain
+        for (auto task : tasks) {
+            std::vector<wrench::WorkflowTask *> cluster = {task};
+            auto workflow = task->getWorkflow();
+            while (cluster.size() < this->cluster_size) {
+                auto children = workflow->getTaskChildren(cluster.back());
+                if (children.size() != 1 || workflow->getTaskParents(children.front()).size() != 1) {
+                    break;
+                }
+                cluster.push_back(children.front());
+            }
+            clusters.push_back(cluster);
+        }
+
+    } else {
+        // tasks the algorithm planned on different hosts are never bundled together, so that the VM selected
+        // for the first task of a cluster is on the host planned for all its tasks
+        std::map<std::string, std::vector<std::size_t>> task_indices_per_host;
+        for (std::size_t i = 0; i < tasks.size(); i++) {
+            task_indices_per_host[scheduling_algorithm.getPlannedHost(tasks[i])].push_back(i);
+        }
+
+        std::vector<std::vector<std::size_t>> cluster_task_indices;
+        for (auto const &host_task_indices : task_indices_per_host) {
+            this->balanceClusters(tasks, host_task_indices.second, cluster_task_indices);
+        }
+
+        // keep the scheduling algorithm order, within and across clusters
+        for (auto &indices : cluster_task_indices) {
+            std::sort(indices.begin(), indices.end());
+        }
+        std::sort(cluster_task_indices.begin(), cluster_task_indices.end());
+        clusters.resize(cluster_task_indices.size());
+        for (std::size_t c = 0; c < cluster_task_indices.size(); c++) {
+            for (auto i : cluster_task_indices[c]) {
+                clusters[c].push_back(tasks[i]);
+            }
+        }
+    }
+    return clusters;
+}
+
+/**
+ * @brief Group tasks into ceil(n / cluster size) runtime-balanced clusters, longest processing time first: each
+ *        task joins the non-full cluster with the least work (ties going to the first cluster), found in a
+ *        min-heap of the non-full clusters keyed by (work, cluster index)
+ *
+ * @param tasks: the sorted ready tasks
+ * @param task_indices: the indices, in tasks, of the tasks to group
+ * @param cluster_task_indices: the clusters, as indices in tasks, to which the new clusters are appended
+ */
+void EnergyAwareStandardJobScheduler::balanceClusters(const std::vector<wrench::WorkflowTask *> &tasks,
+                                                      const std::vector<std::size_t> &task_indices,
+                                                      std::vector<std::vector<std::size_t>> &cluster_task_indices) {
+    auto first_cluster = cluster_task_indices.size();
+    auto num_clusters = (task_indices.size() + this->cluster_size - 1) / this->cluster_size;
+    cluster_task_indices.resize(first_cluster + num_clusters);
+
+    auto task_order = task_indices;
+    std::stable_sort(task_order.begin(), task_order.end(), [&tasks](std::size_t i1, std::size_t i2) {
+        return tasks[i1]->getFlops() > tasks[i2]->getFlops();
+    });
+
+    std::priority_queue<std::pair<double, std::size_t>, std::vector<std::pair<double, std::size_t>>,
+            std::greater<std::pair<double, std::size_t>>> non_full_clusters;
+    for (std::size_t c = first_cluster; c < cluster_task_indices.size(); c++) {
+        non_full_clusters.push(std::make_pair(0.0, c));
+    }
+
+    for (auto i : task_order) {
+        auto selected = non_full_clusters.top();
+        non_full_clusters.pop();
+        cluster_task_indices[selected.second].push_back(i);
+        if (cluster_task_indices[selected.second].size() < this->cluster_size) {
+            non_full_clusters.push(std::make_pair(selected.first + tasks[i]->getFlops(), selected.second));
         }
     }
 }
 
 /**
  * Notify that a task has completed its execution.
- * @param compute_services
  * @param task Pointer to task that has completed its execution.
+ * @return the name of the VM of the task if it went idle and is kept warm by the VM pool (the caller should
+ *         call notifyVMKeepAliveExpiration() once the keep-alive timeout has elapsed), or an empty string
  */
-void EnergyAwareStandardJobScheduler::notifyTaskCompletion(
-        const std::set<std::shared_ptr<wrench::ComputeService>> &compute_services,
-        wrench::WorkflowTask *task) {
+std::string EnergyAwareStandardJobScheduler::notifyTaskCompletion(wrench::WorkflowTask *task) {
+    auto it = this->tasks_vm_map.find(task);
+    if (it != this->tasks_vm_map.end()) {
+        this->vm_algorithms.at(it->second)->notifyTaskCompletion(it->second);
+    }
+
     if (this->unscheduled_tasks > 0) {
         this->unscheduled_tasks--;
     } else {
-        auto it = this->tasks_vm_map.find(task);
-        auto cloud_service = std::dynamic_pointer_cast<wrench::CloudComputeService>(*compute_services.begin());
+        auto scheduling_algorithm = this->vm_algorithms.at(it->second);
+        auto cloud_service = scheduling_algorithm->getCloudService();
+        // the VM of a multi-task job is released when its first task completion is processed
+        if (!cloud_service->isVMRunning(it->second) || this->vm_pool.isIdle(it->second)) {
+            return "";
+        }
         auto vm_cs = cloud_service->getVMComputeService(it->second);
         if (vm_cs->getTotalNumCores() == vm_cs->getTotalNumIdleCores()) {
             auto vm_pm = cloud_service->getVMPhysicalHostname(it->second);
+            if (this->vm_pool.release(it->second, vm_pm, wrench::Simulation::getCurrentSimulatedDate())) {
+                return it->second;
+            }
             cloud_service->shutdownVM(it->second);
-            this->scheduling_algorithm->notifyVMShutdown(it->second, vm_pm);
+            scheduling_algorithm->notifyVMShutdown(it->second, vm_pm);
+        }
+    }
+    return "";
+}
+
+/**
+ * @brief Notify that the keep-alive timeout of a VM released to the VM pool has elapsed, so that the VM is
+ *        shut down if it stayed idle
+ *
+ * @param vm_name: the VM name
+ */
+void EnergyAwareStandardJobScheduler::notifyVMKeepAliveExpiration(const std::string &vm_name) {
+    if (!this->vm_pool.expire(vm_name, wrench::Simulation::getCurrentSimulatedDate())) {
+        return;
+    }
+    auto scheduling_algorithm = this->vm_algorithms.at(vm_name);
+    auto cloud_service = scheduling_algorithm->getCloudService();
+    if (!cloud_service->isVMRunning(vm_name)) {
+        return;
+    }
+    auto vm_cs = cloud_service->getVMComputeService(vm_name);
+    if (vm_cs->getTotalNumCores() == vm_cs->getTotalNumIdleCores()) {
+        auto vm_pm = cloud_service->getVMPhysicalHostname(vm_name);
+        cloud_service->shutdownVM(vm_name);
+        scheduling_algorithm->notifyVMShutdown(vm_name, vm_pm);
+    }
+}
+
+/**
+ * @brief Get the VM pool, e.g., to obtain its hit/miss statistics
+ *
+ * @return the VM pool
+ */
+const VMPool &EnergyAwareStandardJobScheduler::getVMPool() const {
+    return this->vm_pool;
+}
+
+/**
+ * @brief Set the power meters that should be notified when tasks are dispatched to VMs on the hosts they meter
+ *
+ * @param power_meters: list of power meters
+ */
+void EnergyAwareStandardJobScheduler::setPowerMeters(const std::vector<std::shared_ptr<PowerMeter>> &power_meters) {
+    this->power_meters_per_host.clear();
+    for (auto const &power_meter : power_meters) {
+        for (auto const &hostname : power_meter->getHostnames()) {
+            this->power_meters_per_host[hostname].push_back(power_meter);
         }
     }
 }
@@ -10,27 +10,72 @@
 #ifndef ENERGY_AWARE_ENERGYAWARESTANDARDJOBSCHEDULER_H
 #define ENERGY_AWARE_ENERGYAWARESTANDARDJOBSCHEDULER_H
 
+#include <unordered_map>
 #include <wrench-dev.h>
 
+#include "PowerMeter.h"
+#include "VMPool.h"
 #include "cost_model/CostModel.h"
 #include "scheduling_algorithm/SchedulingAlgorithm.h"
 
 class EnergyAwareStandardJobScheduler : public wrench::StandardJobScheduler {
 public:
+    /** @brief How ready tasks are bundled into standard jobs */
+    enum TaskClustering {
+        /** @brief One standard job per task */
+        NO_CLUSTERING,
+        /** @brief Independent ready tasks, grouped into runtime-balanced clusters */
+        HORIZONTAL,
+        /** @brief A ready task and its chain of single-parent, single-child descendants */
+        VERTICAL
+    };
+
     EnergyAwareStandardJobScheduler(std::shared_ptr<wrench::StorageService> storage_service,
-                                    std::unique_ptr<SchedulingAlgorithm> scheduling_algorithm);
+                                    std::vector<std::unique_ptr<SchedulingAlgorithm>> scheduling_algorithms,
+                                    TaskClustering task_clustering = NO_CLUSTERING,
+                                    unsigned long cluster_size = 1,
+                                    VMPool vm_pool = VMPool());
 
     void scheduleTasks(const std::set<std::shared_ptr<wrench::ComputeService>> &compute_services,
                        const std::vector<wrench::WorkflowTask *> &tasks) override;
 
-    void notifyTaskCompletion(const std::set<std::shared_ptr<wrench::ComputeService>> &compute_services,
-                              wrench::WorkflowTask *task);
+    std::string notifyTaskCompletion(wrench::WorkflowTask *task);
+
+    void notifyVMKeepAliveExpiration(const std::string &vm_name);
+
+    const VMPool &getVMPool() const;
+
+    void setPowerMeters(const std::vector<std::shared_ptr<PowerMeter>> &power_meters);
 
 private:
+    std::vector<wrench::WorkflowTask *> scheduleTasksOnService(SchedulingAlgorithm &scheduling_algorithm,
+                                                               const std::vector<wrench::WorkflowTask *> &tasks);
+
+    void computeWattsPerCore();
+
+    std::vector<std::vector<wrench::WorkflowTask *>> clusterTasks(const SchedulingAlgorithm &scheduling_algorithm,
+                                                                  const std::vector<wrench::WorkflowTask *> &tasks);
+
+    void balanceClusters(const std::vector<wrench::WorkflowTask *> &tasks,
+                         const std::vector<std::size_t> &task_indices,
+                         std::vector<std::vector<std::size_t>> &cluster_task_indices);
+
+    std::shared_ptr<wrench::FileLocation> getFileLocation(const std::shared_ptr<wrench::StorageService> &storage_service);
+
     std::shared_ptr<wrench::StorageService> default_storage_service;
-    std::unique_ptr<SchedulingAlgorithm> scheduling_algorithm;
+    std::vector<std::unique_ptr<SchedulingAlgorithm>> scheduling_algorithms;
+    /** @brief Average peak power per core of the hosts of each cloud service */
+    std::vector<double> watts_per_core;
+    TaskClustering task_clustering;
+    unsigned long cluster_size;
+    VMPool vm_pool;
     int unscheduled_tasks;
     std::map<wrench::WorkflowTask *, std::string> tasks_vm_map;
+    /** @brief The algorithm (hence the cloud service) that created each VM */
+    std::unordered_map<std::string, SchedulingAlgorithm *> vm_algorithms;
+    std::unordered_map<std::string, std::vector<std::shared_ptr<PowerMeter>>> power_meters_per_host;
+    /** @brief File locations, interned per storage service */
+    std::unordered_map<wrench::StorageService *, std::shared_ptr<wrench::FileLocation>> file_locations_per_service;
 };
 
 #endif //ENERGY_AWARE_ENERGYAWARESTANDARDJOBSCHEDULER_H
@@ -0,0 +1,232 @@
+/**
+ * Copyright (c) 2020-2021. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "EnergyTraceStore.h"
+
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+/**
+ * @brief Register a host, if not already registered
+ *
+ * @param hostname: the host name
+ *
+ * @return the host ID
+ */
+unsigned int EnergyTraceStore::registerHost(const std::string &hostname) {
+    auto it = this->host_ids.find(hostname);
+    if (it != this->host_ids.end()) {
+        return it->second;
+    }
+    unsigned int host_id = this->hostnames.size();
+    this->hostnames.push_back(hostname);
+    this->host_ids.insert(std::make_pair(hostname, host_id));
+    return host_id;
+}
+
+/**
+ * @brief Register a power model, if not already registered
+ *
+ * @param model_name: the power model name
+ *
+ * @return the power model ID
+ *
+ * @throw std::runtime_error
+ */
+unsigned int EnergyTraceStore::registerModel(const std::string &model_name) {
+    auto it = this->model_ids.find(model_name);
+    if (it != this->model_ids.end()) {
+        return it->second;
+    }
+    if (this->model_names.size() > std::numeric_limits<uint8_t>::max()) {
+        throw std::runtime_error("EnergyTraceStore::registerModel(): too many power models");
+    }
+    unsigned int model_id = this->model_names.size();
+    this->model_names.push_back(model_name);
+    this->model_ids.insert(std::make_pair(model_name, model_id));
+    return model_id;
+}
+
+/**
+ * @brief Get the ID of a registered host
+ *
+ * @param hostname: the host name
+ *
+ * @return the host ID
+ *
+ * @throw std::invalid_argument
+ */
+unsigned int EnergyTraceStore::getHostID(const std::string &hostname) const {
+    auto it = this->host_ids.find(hostname);
+    if (it == this->host_ids.end()) {
+        throw std::invalid_argument("EnergyTraceStore::getHostID(): unknown host " + hostname);
+    }
+    return it->second;
+}
+
+/**
+ * @brief Get the ID of a registered power model
+ *
+ * @param model_name: the power model name
+ *
+ * @return the power model ID
+ *
+ * @throw std::invalid_argument
+ */
+unsigned int EnergyTraceStore::getModelID(const std::string &model_name) const {
+    auto it = this->model_ids.find(model_name);
+    if (it == this->model_ids.end()) {
+        throw std::invalid_argument("EnergyTraceStore::getModelID(): unknown power model " + model_name);
+    }
+    return it->second;
+}
+
+/**
+ * @brief Check whether a host is registered
+ *
+ * @param hostname: the host name
+ *
+ * @return true if the host is registered
+ */
+bool EnergyTraceStore::hasHost(const std::string &hostname) const {
+    return this->host_ids.find(hostname) != this->host_ids.end();
+}
+
+/**
+ * @brief Check whether a power model is registered
+ *
+ * @param model_name: the power model name
+ *
+ * @return true if the power model is registered
+ */
+bool EnergyTraceStore::hasModel(const std::string &model_name) const {
+    return this->model_ids.find(model_name) != this->model_ids.end();
+}
+
+/**
+ * @brief Get the registered host names, indexed by host ID
+ *
+ * @return list of host names
+ */
+const std::vector<std::string> &EnergyTraceStore::getHostnames() const {
+    return this->hostnames;
+}
+
+/**
+ * @brief Get the registered power model names, indexed by power model ID
+ *
+ * @return list of power model names
+ */
+const std::vector<std::string> &EnergyTraceStore::getModelNames() const {
+    return this->model_names;
+}
+
+/**
+ * @brief Append a power measurement to the store
+ *
+ * @param date: the measurement date
+ * @param host_id: the ID of the measured host
+ * @param model_id: the ID of the power model
+ * @param consumption: the measured power consumption (in W)
+ */
+void EnergyTraceStore::addMeasurement(double date, unsigned int host_id, unsigned int model_id,
+                                      double consumption) {
+    this->dates.push_back(date);
+    this->measurement_hosts.push_back(host_id);
+    this->measurement_models.push_back(model_id);
+    this->consumptions.push_back(consumption);
+}
+
+/**
+ * @brief Get the number of measurements in the store
+ *
+ * @return the number of measurements
+ */
+std::size_t EnergyTraceStore::getNumMeasurements() const {
+    return this->dates.size();
+}
+
+/**
+ * @brief Get the column of measurement dates
+ *
+ * @return the measurement dates
+ */
+const std::vector<double> &EnergyTraceStore::getDates() const {
+    return this->dates;
+}
+
+/**
+ * @brief Get the column of measured host IDs
+ *
+ * @return the measured host IDs
+ */
+const std::vector<uint32_t> &EnergyTraceStore::getHostIDs() const {
+    return this->measurement_hosts;
+}
+
+/**
+ * @brief Get the column of power model IDs
+ *
+ * @return the power model IDs
+ */
+const std::vector<uint8_t> &EnergyTraceStore::getModelIDs() const {
+    return this->measurement_models;
+}
+
+/**
+ * @brief Get the column of measured power consumptions
+ *
+ * @return the power consumptions (in W)
+ */
+const std::vector<double> &EnergyTraceStore::getConsumptions() const {
+    return this->consumptions;
+}
+
+/**
+ * @brief Dump the store into a binary file (native byte order). The file holds the "EATRACE1" magic,
+ *        the host and power model name tables (uint32 count, then uint32 length and bytes per name),
+ *        the uint64 number of measurements, and the date (double), host (uint32), model (uint8)
+ *        and consumption (double) columns, one after the other.
+ *
+ * @param file_path: path to the output file
+ *
+ * @throw std::runtime_error
+ */
+void EnergyTraceStore::dumpBinary(const std::string &file_path) const {
+    std::ofstream output(file_path, std::ios::binary | std::ios::trunc);
+    if (!output) {
+        throw std::runtime_error("EnergyTraceStore::dumpBinary(): cannot open " + file_path);
+    }
+
+    auto write_names = [&output](const std::vector<std::string> &names) {
+        auto count = (uint32_t) names.size();
+        output.write((const char *) &count, sizeof(count));
+        for (auto const &name : names) {
+            auto length = (uint32_t) name.size();
+            output.write((const char *) &length, sizeof(length));
+            output.write(name.data(), length);
+        }
+    };
+
+    output.write("EATRACE1", 8);
+    write_names(this->hostnames);
+    write_names(this->model_names);
+
+    auto num_measurements = (uint64_t) this->dates.size();
+    output.write((const char *) &num_measurements, sizeof(num_measurements));
+    output.write((const char *) this->dates.data(), num_measurements * sizeof(double));
+    output.write((const char *) this->measurement_hosts.data(), num_measurements * sizeof(uint32_t));
+    output.write((const char *) this->measurement_models.data(), num_measurements * sizeof(uint8_t));
+    output.write((const char *) this->consumptions.data(), num_measurements * sizeof(double));
+
+    if (!output) {
+        throw std::runtime_error("EnergyTraceStore::dumpBinary(): error while writing " + file_path);
+    }
+}
@@ -0,0 +1,66 @@
+/**
+ * Copyright (c) 2020-2021. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef ENERGY_AWARE_ENERGYTRACESTORE_H
+#define ENERGY_AWARE_ENERGYTRACESTORE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief A columnar store of power measurements, in which hosts and power models are interned
+ *        as integer IDs
+ */
+class EnergyTraceStore {
+public:
+    unsigned int registerHost(const std::string &hostname);
+
+    unsigned int registerModel(const std::string &model_name);
+
+    unsigned int getHostID(const std::string &hostname) const;
+
+    unsigned int getModelID(const std::string &model_name) const;
+
+    bool hasHost(const std::string &hostname) const;
+
+    bool hasModel(const std::string &model_name) const;
+
+    const std::vector<std::string> &getHostnames() const;
+
+    const std::vector<std::string> &getModelNames() const;
+
+    void addMeasurement(double date, unsigned int host_id, unsigned int model_id, double consumption);
+
+    std::size_t getNumMeasurements() const;
+
+    const std::vector<double> &getDates() const;
+
+    const std::vector<uint32_t> &getHostIDs() const;
+
+    const std::vector<uint8_t> &getModelIDs() const;
+
+    const std::vector<double> &getConsumptions() const;
+
+    void dumpBinary(const std::string &file_path) const;
+
+private:
+    std::vector<std::string> hostnames;
+    std::unordered_map<std::string, unsigned int> host_ids;
+    std::vector<std::string> model_names;
+    std::unordered_map<std::string, unsigned int> model_ids;
+
+    std::vector<double> dates;
+    std::vector<uint32_t> measurement_hosts;
+    std::vector<uint8_t> measurement_models;
+    std::vector<double> consumptions;
+};
+
+#endif //ENERGY_AWARE_ENERGYTRACESTORE_H
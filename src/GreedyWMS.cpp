@@ -13,6 +13,8 @@
  **/
 
 #include <iostream>
+#include <simgrid/s4u/Actor.hpp>
+#include <simgrid/s4u/Mailbox.hpp>
 
 #include "EnergyAwareStandardJobScheduler.h"
 #include "GreedyWMS.h"
@@ -25,17 +27,39 @@ WRENCH_LOG_CATEGORY(greedy_wms, "Log category for GreedyWMS");
  * @param compute_services: a set of compute services available to run tasks
  * @param storage_services: a set of storage services available to store files
  * @param hostname: the name of the host on which to start the WMS
+ * @param energy_trace: the store in which power measurements are recorded
+ * @param integration_mode: how the power meter computes energy consumption
+ * @param measurement_period: the power meter measurement period
+ * @param max_sampling_interval: maximum time between two recorded measurements (adaptive sampling only)
+ * @param event_coalescing: whether all events pending at the date of an event are processed before the next
+ *                          scheduling round (otherwise, tasks are scheduled after every event)
+ * @param event_coalescing_window: additional simulated time during which the events following a first event
+ *                                 are processed before the next scheduling round (requires event coalescing;
+ *                                 delays scheduling, hence changes the schedule, if greater than 0)
  */
 GreedyWMS::GreedyWMS(std::unique_ptr<wrench::StandardJobScheduler> standard_job_scheduler,
                      const std::set<std::shared_ptr<wrench::ComputeService>> &compute_services,
                      const std::set<std::shared_ptr<wrench::StorageService>> &storage_services,
-                     const std::string &hostname) : WMS(std::move(standard_job_scheduler),
-                                                        nullptr,
-                                                        compute_services,
-                                                        storage_services,
-                                                        {}, nullptr,
-                                                        hostname,
-                                                        "greedy_wms") {}
+                     const std::string &hostname,
+                     std::shared_ptr<EnergyTraceStore> energy_trace,
+                     PowerMeter::IntegrationMode integration_mode,
+                     double measurement_period,
+                     double max_sampling_interval,
+                     bool event_coalescing,
+                     double event_coalescing_window) : WMS(std::move(standard_job_scheduler),
+                                                                         nullptr,
+                                                                         compute_services,
+                                                                         storage_services,
+                                                                         {}, nullptr,
+                                                                         hostname,
+                                                                         "greedy_wms"),
+                                                                     energy_trace(std::move(energy_trace)),
+                                                                     integration_mode(integration_mode),
+                                                                     measurement_period(measurement_period),
+                                                                     max_sampling_interval(max_sampling_interval),
+                                                                     event_coalescing(event_coalescing),
+                                                                     event_coalescing_window(event_coalescing_window),
+                                                                     num_processed_events(0) {}
 
 /**
  * @brief main method of the GreedyWMS daemon
@@ -57,47 +81,98 @@ int GreedyWMS::main() {
     // Create a job manager so that we can create/submit jobs
     auto job_manager = this->createJobManager();
 
-    // start the power meters
-    auto cloud_service = std::dynamic_pointer_cast<wrench::CloudComputeService>(*compute_services.begin());
-    // traditional power meter
-    auto traditional_power_meter = std::make_shared<PowerMeter>(this, cloud_service->getExecutionHosts(), 1.0, true,
-                                                                false);
-    traditional_power_meter->simulation = this->simulation;
-    traditional_power_meter->start(traditional_power_meter, true, true); // Always daemonize
-    // pairwise power meter
-    auto pairwise_power_meter = std::make_shared<PowerMeter>(this, cloud_service->getExecutionHosts(), 1.0, false,
-                                                             true);
-    pairwise_power_meter->simulation = this->simulation;
-    pairwise_power_meter->start(pairwise_power_meter, true, true); // Always daemonize
-    // unpaired power meter
-    auto unpaired_power_meter = std::make_shared<PowerMeter>(this, cloud_service->getExecutionHosts(), 1.0, false,
-                                                             false);
-    unpaired_power_meter->simulation = this->simulation;
-    unpaired_power_meter->start(unpaired_power_meter, true, true); // Always daemonize
-
-    // turn off workers
-    for (auto &host : cloud_service->getExecutionHosts()) {
-        wrench::Simulation::turnOffHost(host);
+    // start one power meter per cloud service, which evaluates all power models in a single pass
+    this->power_meters.clear();
+    for (auto const &compute_service : compute_services) {
+        auto cloud_service = std::dynamic_pointer_cast<wrench::CloudComputeService>(compute_service);
+        if (!cloud_service) {
+            continue;
+        }
+        auto power_meter = std::make_shared<PowerMeter>(
+                this, cloud_service->getExecutionHosts(), this->measurement_period, this->energy_trace,
+                std::vector<PowerMeter::PowerModel>{PowerMeter::TRADITIONAL, PowerMeter::PAIRWISE,
+                                                    PowerMeter::UNPAIRED},
+                this->integration_mode, this->max_sampling_interval);
+        power_meter->simulation = this->simulation;
+        power_meter->start(power_meter, true, true); // Always daemonize
+        this->power_meters.push_back(power_meter);
+
+        // turn off workers
+        for (auto &host : cloud_service->getExecutionHosts()) {
+            wrench::Simulation::turnOffHost(host);
+        }
+    }
+
+    auto scheduler = (EnergyAwareStandardJobScheduler *) (this->getStandardJobScheduler());
+    scheduler->setPowerMeters(this->power_meters);
+
+    // the ready queue is then maintained as tasks complete, rather than by rescanning the workflow
+    for (auto task : this->getWorkflow()->getReadyTasks()) {
+        this->ready_tasks.insert(task);
     }
 
     // While the workflow is not done, repeat the main loop
     while (not this->getWorkflow()->isDone()) {
-        // Get the ready tasks
-        auto ready_tasks = this->getWorkflow()->getReadyTasks();
-
-        // Schedule them
+        // Schedule the newly ready and still pending tasks
         WRENCH_INFO("Scheduling tasks...");
-        this->getStandardJobScheduler()->scheduleTasks(compute_services, ready_tasks);
+        std::vector<wrench::WorkflowTask *> tasks_to_schedule(this->ready_tasks.begin(), this->ready_tasks.end());
+        this->getStandardJobScheduler()->scheduleTasks(compute_services, tasks_to_schedule);
+
+        // forget the tasks that have been submitted
+        for (auto it = this->ready_tasks.begin(); it != this->ready_tasks.end();) {
+            if ((*it)->getState() != wrench::WorkflowTask::State::READY) {
+                it = this->ready_tasks.erase(it);
+            } else {
+                ++it;
+            }
+        }
 
         // Wait for a workflow execution event and process it
         WRENCH_INFO("Waiting for next event");
         this->waitForAndProcessNextEvent();
+        this->num_processed_events++;
+
+        // coalesce the events already pending at this date (and those that arrive within the optional window)
+        // into the same scheduling round: an event is only received once its message is pending in the
+        // callback mailbox, so that no receive times out and cancels a message still in flight
+        if (this->event_coalescing) {
+            auto callback_mailbox = simgrid::s4u::Mailbox::by_name(this->getWorkflow()->getCallbackMailbox());
+            double deadline = wrench::Simulation::getCurrentSimulatedDate() + this->event_coalescing_window;
+            while (not this->getWorkflow()->isDone()) {
+                if (callback_mailbox->listen()) {
+                    this->waitForAndProcessNextEvent();
+                    this->num_processed_events++;
+                } else if (wrench::Simulation::getCurrentSimulatedDate() < deadline) {
+                    simgrid::s4u::this_actor::sleep_for(deadline - wrench::Simulation::getCurrentSimulatedDate());
+                } else {
+                    break;
+                }
+            }
+        }
     }
 
     WRENCH_INFO("Workflow execution complete");
     return 0;
 }
 
+/**
+ * @brief Get the power meters started by the WMS
+ *
+ * @return list of power meters
+ */
+std::vector<std::shared_ptr<PowerMeter>> GreedyWMS::getPowerMeters() const {
+    return this->power_meters;
+}
+
+/**
+ * @brief Get the number of workflow execution events processed by the WMS
+ *
+ * @return number of events
+ */
+unsigned long GreedyWMS::getNumProcessedEvents() const {
+    return this->num_processed_events;
+}
+
 /**
  * @brief Process a standard job completion event
  *
@@ -112,10 +187,38 @@ void GreedyWMS::processEventStandardJobCompletion(std::shared_ptr<wrench::Standa
         // notify task completion
         WRENCH_INFO("Notified that a standard job has completed task %s", task->getID().c_str());
         auto scheduler = (EnergyAwareStandardJobScheduler *) (this->getStandardJobScheduler());
-        scheduler->notifyTaskCompletion(this->getAvailableComputeServices<wrench::ComputeService>(), task);
+        auto idle_vm = scheduler->notifyTaskCompletion(task);
+
+        // an idle VM kept warm is reconsidered once its keep-alive timeout has elapsed
+        if (!idle_vm.empty()) {
+            this->setTimer(wrench::Simulation::getCurrentSimulatedDate() +
+                           scheduler->getVMPool().getKeepAliveTimeout(), idle_vm);
+        }
+
+        // stop metering the task
+        for (auto &power_meter : this->power_meters) {
+            power_meter->notifyTaskCompletion(task);
+        }
+
+        // children become ready when their last parent completes
+        for (auto child : this->getWorkflow()->getTaskChildren(task)) {
+            if (child->getState() == wrench::WorkflowTask::State::READY) {
+                this->ready_tasks.insert(child);
+            }
+        }
     }
 }
 
+/**
+ * @brief Process a timer event, which marks the end of the keep-alive timeout of an idle VM
+ *
+ * @param event: the event, whose content is the VM name
+ */
+void GreedyWMS::processEventTimer(std::shared_ptr<wrench::TimerEvent> event) {
+    auto scheduler = (EnergyAwareStandardJobScheduler *) (this->getStandardJobScheduler());
+    scheduler->notifyVMKeepAliveExpiration(event->content);
+}
+
 /**
  * @brief Process a standard job failure event
  *
@@ -24,16 +24,46 @@ public:
     GreedyWMS(std::unique_ptr<wrench::StandardJobScheduler> standard_job_scheduler,
               const std::set<std::shared_ptr<wrench::ComputeService>> &compute_services,
               const std::set<std::shared_ptr<wrench::StorageService>> &storage_services,
-              const std::string &hostname);
+              const std::string &hostname,
+              std::shared_ptr<EnergyTraceStore> energy_trace,
+              PowerMeter::IntegrationMode integration_mode = PowerMeter::SAMPLING,
+              double measurement_period = 1.0,
+              double max_sampling_interval = 60.0,
+              bool event_coalescing = false,
+              double event_coalescing_window = 0);
 
     // Overridden method
     void processEventStandardJobCompletion(std::shared_ptr<wrench::StandardJobCompletedEvent>) override;
 
     void processEventStandardJobFailure(std::shared_ptr<wrench::StandardJobFailedEvent>) override;
 
+    void processEventTimer(std::shared_ptr<wrench::TimerEvent>) override;
+
+    std::vector<std::shared_ptr<PowerMeter>> getPowerMeters() const;
+
+    unsigned long getNumProcessedEvents() const;
+
 private:
     // main() method of the WMS
     int main() override;
+
+    /** @brief Orders ready tasks by ID, as Workflow::getReadyTasks() does */
+    struct TaskIDComparator {
+        bool operator()(const wrench::WorkflowTask *lhs, const wrench::WorkflowTask *rhs) const {
+            return lhs->getID() < rhs->getID();
+        }
+    };
+
+    std::vector<std::shared_ptr<PowerMeter>> power_meters;
+    std::shared_ptr<EnergyTraceStore> energy_trace;
+    PowerMeter::IntegrationMode integration_mode;
+    double measurement_period;
+    double max_sampling_interval;
+    bool event_coalescing;
+    double event_coalescing_window;
+    unsigned long num_processed_events;
+    /** @brief Ready tasks that have not been submitted yet, maintained as tasks complete */
+    std::set<wrench::WorkflowTask *, TaskIDComparator> ready_tasks;
 };
 
 #endif //ENERGY_AWARE_GREEDYWMS_H
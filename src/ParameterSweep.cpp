@@ -0,0 +1,255 @@
+/**
+ * Copyright (c) 2020-2021. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "ParameterSweep.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+const std::string ParameterSweep::CSV_HEADER = "label,tasks,algorithm,power_model,energy_wh,makespan_s";
+
+/**
+ * @brief Constructor. Each non-empty line of the job matrix file that does not start with '#' holds the
+ *        whitespace-separated command-line arguments of one simulation.
+ *
+ * @param executable: path to the simulator executable
+ * @param job_matrix_file: path to the job matrix file
+ * @param output_file: path to the merged CSV file
+ * @param num_workers: maximum number of simulations running at the same time (0 means one per core)
+ * @param common_args: arguments passed to every simulation, before its own arguments
+ *
+ * @throw std::invalid_argument
+ */
+ParameterSweep::ParameterSweep(std::string executable,
+                               const std::string &job_matrix_file,
+                               std::string output_file,
+                               unsigned int num_workers,
+                               std::vector<std::string> common_args) :
+        executable(std::move(executable)),
+        output_file(std::move(output_file)),
+        num_workers(num_workers),
+        common_args(std::move(common_args)) {
+    std::ifstream input(job_matrix_file);
+    if (!input) {
+        throw std::invalid_argument("ParameterSweep::ParameterSweep(): cannot open job matrix " + job_matrix_file);
+    }
+
+    std::string line;
+    while (std::getline(input, line)) {
+        std::istringstream tokens(line);
+        std::vector<std::string> args;
+        std::string token;
+        while (tokens >> token) {
+            args.push_back(token);
+        }
+        if (args.empty() || args.front()[0] == '#') {
+            continue;
+        }
+        this->addJob(args);
+    }
+
+    if (this->num_workers == 0) {
+        this->num_workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+/**
+ * @brief Constructor
+ *
+ * @param executable: path to the simulator executable
+ * @param job_args: the command-line arguments of each simulation
+ * @param output_file: path to the merged CSV file
+ * @param num_workers: maximum number of simulations running at the same time (0 means one per core)
+ * @param common_args: arguments passed to every simulation, before its own arguments
+ */
+ParameterSweep::ParameterSweep(std::string executable,
+                               const std::vector<std::vector<std::string>> &job_args,
+                               std::string output_file,
+                               unsigned int num_workers,
+                               std::vector<std::string> common_args) :
+        executable(std::move(executable)),
+        output_file(std::move(output_file)),
+        num_workers(num_workers),
+        common_args(std::move(common_args)) {
+    for (auto const &args : job_args) {
+        this->addJob(args);
+    }
+
+    if (this->num_workers == 0) {
+        this->num_workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+/**
+ * @brief Get the simulations of the sweep, with their resource usage once the sweep has run
+ *
+ * @return the jobs, in job order
+ */
+const std::vector<ParameterSweep::Job> &ParameterSweep::getJobs() const {
+    return this->jobs;
+}
+
+/**
+ * @brief Add a simulation to the sweep
+ *
+ * @param args: the command-line arguments of the simulation
+ */
+void ParameterSweep::addJob(std::vector<std::string> args) {
+    Job job;
+    job.args = std::move(args);
+    auto job_prefix = this->output_file + "." + std::to_string(this->jobs.size());
+    job.results_file = job_prefix + ".csv";
+    job.log_file = job_prefix + ".log";
+    this->jobs.push_back(job);
+}
+
+/**
+ * @brief Run all simulations of the sweep through a work queue, then merge their results
+ *
+ * @return 0 if all simulations succeeded, 1 otherwise
+ */
+int ParameterSweep::run() {
+    std::cerr << "Running " << this->jobs.size() << " simulations on " << this->num_workers << " workers"
+              << std::endl;
+
+    std::map<int, Job *> running_jobs;
+    std::size_t next_job = 0;
+    std::size_t num_failed = 0;
+
+    while (next_job < this->jobs.size() || !running_jobs.empty()) {
+        // fill idle workers
+        while (next_job < this->jobs.size() && running_jobs.size() < this->num_workers) {
+            auto &job = this->jobs[next_job++];
+            this->launchJob(job);
+            if (job.pid > 0) {
+                running_jobs[job.pid] = &job;
+            } else {
+                num_failed++;
+            }
+        }
+        if (running_jobs.empty()) {
+            continue;
+        }
+
+        // wait for any worker to complete
+        int status;
+        struct rusage usage;
+        int pid = wait4(-1, &status, 0, &usage);
+        if (pid < 0) {
+            throw std::runtime_error("ParameterSweep::run(): wait4() failed");
+        }
+        auto it = running_jobs.find(pid);
+        if (it == running_jobs.end()) {
+            continue;
+        }
+        auto job = it->second;
+        running_jobs.erase(it);
+
+        job->wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - job->start_time).count();
+        job->max_rss = usage.ru_maxrss;
+
+        job->succeeded = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        if (job->succeeded) {
+            std::remove(job->log_file.c_str());
+        } else {
+            num_failed++;
+            std::cerr << "Simulation failed (see " << job->log_file << "):";
+            for (auto const &arg : job->args) {
+                std::cerr << " " << arg;
+            }
+            std::cerr << std::endl;
+        }
+    }
+
+    if (!this->mergeResults()) {
+        return 1;
+    }
+    std::cerr << "Sweep complete: " << (this->jobs.size() - num_failed) << "/" << this->jobs.size()
+              << " simulations succeeded, results in " << this->output_file << std::endl;
+    return num_failed == 0 ? 0 : 1;
+}
+
+/**
+ * @brief Start a worker process running one simulation, with its output redirected to the job log file
+ *
+ * @param job: the job
+ */
+void ParameterSweep::launchJob(Job &job) {
+    std::vector<std::string> args = {this->executable};
+    args.insert(args.end(), this->common_args.begin(), this->common_args.end());
+    args.insert(args.end(), job.args.begin(), job.args.end());
+    args.push_back("--results=" + job.results_file);
+
+    // a simulation that fails before writing its results must not leave those of an earlier sweep in place
+    std::remove(job.results_file.c_str());
+
+    std::vector<char *> argv;
+    for (auto &arg : args) {
+        argv.push_back(&arg[0]);
+    }
+    argv.push_back(nullptr);
+
+    job.start_time = std::chrono::steady_clock::now();
+    job.pid = fork();
+    if (job.pid == 0) {
+        int fd = open(job.log_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd >= 0) {
+            dup2(fd, STDOUT_FILENO);
+            dup2(fd, STDERR_FILENO);
+            close(fd);
+        }
+        execvp(argv[0], argv.data());
+        std::perror("execvp");
+        _exit(127);
+    } else if (job.pid < 0) {
+        std::cerr << "Unable to start a worker process for job " << job.results_file << std::endl;
+    }
+}
+
+/**
+ * @brief Merge the results of all successful simulations, in job order, into the output CSV file
+ *
+ * @return true on success
+ */
+bool ParameterSweep::mergeResults() {
+    std::ofstream output(this->output_file, std::ios::trunc);
+    if (!output) {
+        std::cerr << "Cannot open " << this->output_file << std::endl;
+        return false;
+    }
+    output << CSV_HEADER << std::endl;
+
+    for (auto const &job : this->jobs) {
+        // failed simulations may have written partial results
+        if (!job.succeeded) {
+            std::remove(job.results_file.c_str());
+            continue;
+        }
+        std::ifstream input(job.results_file);
+        std::string line;
+        while (std::getline(input, line)) {
+            if (!line.empty() && line != CSV_HEADER) {
+                output << line << std::endl;
+            }
+        }
+        input.close();
+        std::remove(job.results_file.c_str());
+    }
+    return true;
+}
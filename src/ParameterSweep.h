@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2020-2021. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef ENERGY_AWARE_PARAMETERSWEEP_H
+#define ENERGY_AWARE_PARAMETERSWEEP_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * @brief A driver that runs a matrix of simulations, each one in its own worker process, and
+ *        merges their results into a single CSV file
+ */
+class ParameterSweep {
+public:
+    /** @brief Header of the CSV result files */
+    static const std::string CSV_HEADER;
+
+    /** @brief A single simulation of the sweep */
+    struct Job {
+        std::vector<std::string> args;
+        std::string results_file;
+        std::string log_file;
+        int pid = -1;
+        bool succeeded = false;
+        std::chrono::steady_clock::time_point start_time;
+        /** @brief Wall-clock time of the simulation (seconds) */
+        double wall_time = 0;
+        /** @brief Peak resident set size of the worker process (KiB) */
+        long max_rss = 0;
+    };
+
+    ParameterSweep(std::string executable,
+                   const std::string &job_matrix_file,
+                   std::string output_file,
+                   unsigned int num_workers,
+                   std::vector<std::string> common_args = {});
+
+    ParameterSweep(std::string executable,
+                   const std::vector<std::vector<std::string>> &job_args,
+                   std::string output_file,
+                   unsigned int num_workers,
+                   std::vector<std::string> common_args = {});
+
+    int run();
+
+    const std::vector<Job> &getJobs() const;
+
+private:
+    void addJob(std::vector<std::string> args);
+
+    void launchJob(Job &job);
+
+    bool mergeResults();
+
+    std::string executable;
+    std::string output_file;
+    unsigned int num_workers;
+    std::vector<std::string> common_args;
+    std::vector<Job> jobs;
+};
+
+#endif //ENERGY_AWARE_PARAMETERSWEEP_H
@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2020-2021. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "PlatformGenerator.h"
+
+#include <fstream>
+#include <stdexcept>
+
+/**
+ * @brief Constructor
+ *
+ * @param num_hosts: number of worker hosts
+ * @param num_cores: number of cores per worker host
+ * @param wattage_per_state: the wattage_per_state profile of the worker hosts ("idle:one core:all cores")
+ * @param watt_off: the power consumption of a worker host that is turned off
+ * @param disk_bandwidth: the read/write bandwidth of the disks (e.g., "100MBps")
+ * @param num_clusters: number of clusters the worker hosts are evenly split into, each one managed
+ *                      by its own cloud service
+ *
+ * @throw std::invalid_argument
+ */
+PlatformGenerator::PlatformGenerator(unsigned long num_hosts,
+                                     unsigned long num_cores,
+                                     std::string wattage_per_state,
+                                     std::string watt_off,
+                                     std::string disk_bandwidth,
+                                     unsigned long num_clusters)
+        : num_hosts(num_hosts), num_cores(num_cores), wattage_per_state(std::move(wattage_per_state)),
+          watt_off(std::move(watt_off)), disk_bandwidth(std::move(disk_bandwidth)), num_clusters(num_clusters) {
+    if (this->num_hosts == 0) {
+        throw std::invalid_argument("PlatformGenerator::PlatformGenerator(): at least one worker host is required");
+    }
+    if (this->num_cores == 0) {
+        throw std::invalid_argument("PlatformGenerator::PlatformGenerator(): worker hosts need at least one core");
+    }
+    if (this->num_clusters == 0 || this->num_clusters > this->num_hosts) {
+        throw std::invalid_argument(
+                "PlatformGenerator::PlatformGenerator(): the number of clusters must be between 1 and the number of hosts");
+    }
+}
+
+/**
+ * @brief Write the platform description
+ *
+ * Only the master--worker and data_server--worker routes are declared, with Dijkstra routing,
+ * so that the size of the description and of SimGrid's routing structures grows linearly with
+ * the number of hosts (full routing would allocate a quadratic routing table).
+ *
+ * @param file_path: path to the XML platform file
+ *
+ * @throw std::runtime_error
+ */
+void PlatformGenerator::write(const std::string &file_path) const {
+    std::ofstream output(file_path, std::ios::trunc);
+    if (!output) {
+        throw std::runtime_error("PlatformGenerator::write(): cannot open " + file_path);
+    }
+
+    auto write_disk = [this, &output]() {
+        output << "            <disk id=\"hard_drive\" read_bw=\"" << this->disk_bandwidth << "\" write_bw=\""
+               << this->disk_bandwidth << "\">\n"
+               << "                <prop id=\"size\" value=\"5000GiB\"/>\n"
+               << "                <prop id=\"mount\" value=\"/\"/>\n"
+               << "            </disk>\n";
+    };
+
+    output << "<?xml version='1.0'?>\n"
+           << "<!DOCTYPE platform SYSTEM \"http://simgrid.gforge.inria.fr/simgrid/simgrid.dtd\">\n"
+           << "<platform version=\"4.1\">\n"
+           << "    <zone id=\"AS0\" routing=\"DijkstraCache\">\n";
+
+    output << "        <host id=\"master\" speed=\"1f\" core=\"10\">\n";
+    write_disk();
+    output << "        </host>\n";
+    output << "        <host id=\"data_server\" speed=\"1f\" core=\"1\">\n";
+    write_disk();
+    output << "        </host>\n";
+
+    for (unsigned long i = 1; i <= this->num_hosts; i++) {
+        output << "        <host id=\"worker" << i << "\" speed=\"1f\" core=\"" << this->num_cores << "\">\n"
+               << "            <prop id=\"wattage_per_state\" value=\"" << this->wattage_per_state << "\" />\n"
+               << "            <prop id=\"watt_off\" value=\"" << this->watt_off << "\" />\n";
+        if (this->num_clusters > 1) {
+            output << "            <prop id=\"cluster\" value=\"cluster"
+                   << (i - 1) * this->num_clusters / this->num_hosts << "\" />\n";
+        }
+        write_disk();
+        output << "        </host>\n";
+    }
+
+    output << "        <link id=\"1\" bandwidth=\"1.24GBps\" latency=\"100us\"/>\n"
+           << "        <link id=\"2\" bandwidth=\"55MBps\" latency=\"100us\"/>\n";
+
+    output << "        <route src=\"data_server\" dst=\"master\">\n"
+           << "            <link_ctn id=\"2\"/>\n"
+           << "        </route>\n";
+    for (unsigned long i = 1; i <= this->num_hosts; i++) {
+        output << "        <route src=\"master\" dst=\"worker" << i << "\">\n"
+               << "            <link_ctn id=\"1\"/>\n"
+               << "        </route>\n"
+               << "        <route src=\"data_server\" dst=\"worker" << i << "\">\n"
+               << "            <link_ctn id=\"2\"/>\n"
+               << "        </route>\n";
+    }
+
+    output << "    </zone>\n"
+           << "</platform>\n";
+
+    if (!output) {
+        throw std::runtime_error("PlatformGenerator::write(): error while writing " + file_path);
+    }
+}
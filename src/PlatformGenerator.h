@@ -0,0 +1,39 @@
+/**
+ * Copyright (c) 2020-2021. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef ENERGY_AWARE_PLATFORMGENERATOR_H
+#define ENERGY_AWARE_PLATFORMGENERATOR_H
+
+#include <string>
+
+/**
+ * @brief A generator of SimGrid platforms with a master host, a data server, and any number of
+ *        identical energy-metered worker hosts (the layout of evaluation/platform.xml)
+ */
+class PlatformGenerator {
+public:
+    PlatformGenerator(unsigned long num_hosts,
+                      unsigned long num_cores,
+                      std::string wattage_per_state = "98.080000:112.727273:200.000000",
+                      std::string watt_off = "10",
+                      std::string disk_bandwidth = "100MBps",
+                      unsigned long num_clusters = 1);
+
+    void write(const std::string &file_path) const;
+
+private:
+    unsigned long num_hosts;
+    unsigned long num_cores;
+    std::string wattage_per_state;
+    std::string watt_off;
+    std::string disk_bandwidth;
+    unsigned long num_clusters;
+};
+
+#endif //ENERGY_AWARE_PLATFORMGENERATOR_H
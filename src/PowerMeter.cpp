@@ -8,6 +8,7 @@
  */
 
 #include "PowerMeter.h"
+#include "Profiler.h"
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(power_meter, "Log category for PowerMeter");
 
@@ -17,35 +18,98 @@ XBT_LOG_NEW_DEFAULT_CATEGORY(power_meter, "Log category for PowerMeter");
  * @param wms: the WMS that uses this power meter
  * @param hostnames: the list of metered hosts, as hostnames
  * @param measurement_period: the measurement period
- * @param traditional: whether the traditional power model should be used
- * @param pairwise: whether cores in socket are enabled in pairwise manner
+ * @param energy_trace: the store in which power measurements are recorded (if any)
+ * @param power_models: the power models evaluated on each measurement
+ * @param integration_mode: whether energy is obtained from periodic samples or integrated analytically
+ * @param max_sampling_interval: maximum time between two recorded measurements of a running host
+ *                               (adaptive sampling only)
  */
 PowerMeter::PowerMeter(wrench::WMS *wms,
                        const std::vector<std::string> &hostnames,
                        double measurement_period,
-                       bool traditional,
-                       bool pairwise) :
+                       std::shared_ptr<EnergyTraceStore> energy_trace,
+                       const std::vector<PowerModel> &power_models,
+                       IntegrationMode integration_mode,
+                       double max_sampling_interval) :
         Service(wms->hostname, "power_meter", "power_meter"),
         wms(wms),
-        traditional(traditional),
-        pairwise(pairwise),
-        measurement_period(measurement_period) {
+        power_models(power_models),
+        energy_trace(std::move(energy_trace)),
+        integration_mode(integration_mode),
+        measurement_period(measurement_period),
+        max_sampling_interval(max_sampling_interval),
+        sleeping(false) {
     // sanity checks
     if (hostnames.empty()) {
         throw std::invalid_argument("PowerMeter::PowerMeter(): no host to meter!");
     }
+    if (power_models.empty()) {
+        throw std::invalid_argument("PowerMeter::PowerMeter(): no power model to evaluate!");
+    }
     if (measurement_period < 1) {
         throw std::invalid_argument("PowerMeter::PowerMeter(): measurement period must be at least 1 second");
     }
+    if (integration_mode == ADAPTIVE_SAMPLING && max_sampling_interval < measurement_period) {
+        throw std::invalid_argument(
+                "PowerMeter::PowerMeter(): maximum sampling interval must be at least the measurement period");
+    }
     for (auto const &h : hostnames) {
         if (not wrench::S4U_Simulation::hostExists(h)) {
             throw std::invalid_argument("PowerMeter::PowerMeter(): unknown host " + h);
         }
     }
 
+    // resolve host power constants once, so that no hostname lookup is needed on measurements
+    for (auto const &h : hostnames) {
+        double min_power = wrench::Simulation::getMinPowerConsumption(h);
+        this->host_ids[h] = this->host_table.hostnames.size();
+        this->host_table.hostnames.push_back(h);
+        this->host_table.min_power.push_back(min_power);
+        this->host_table.dynamic_power.push_back(wrench::Simulation::getMaxPowerConsumption(h) - min_power);
+        this->host_table.num_cores.push_back(double(wrench::Simulation::getHostNumCores(h)));
+    }
+    if (this->energy_trace) {
+        for (auto const &h : hostnames) {
+            this->trace_host_ids.push_back(this->energy_trace->registerHost(h));
+        }
+        for (auto power_model : power_models) {
+            this->trace_model_ids.push_back(this->energy_trace->registerModel(getPowerModelName(power_model)));
+        }
+    }
+
+    auto num_hosts = this->host_table.hostnames.size();
+    this->host_activity.num_tasks.assign(num_hosts, 0.0);
+    this->host_activity.pairwise_cpu_load.assign(num_hosts, 0.0);
+    this->host_activity.unpaired_cpu_load.assign(num_hosts, 0.0);
+    this->tasks_per_host.resize(num_hosts);
+    this->power_per_model.assign(power_models.size(), std::vector<double>(num_hosts, 0.0));
+    this->energy_per_model.assign(power_models.size(), std::vector<EnergyAccumulator>(num_hosts));
+    this->integrated_until.assign(num_hosts, 0.0);
+    this->recorded_power_per_model.assign(power_models.size(), std::vector<double>(num_hosts, 0.0));
+    this->recorded_date.assign(num_hosts, 0.0);
+
     this->time_to_next_measurement = 0.0;
 }
 
+/**
+ * @brief Get the name of a power model, as used to label measurements
+ *
+ * @param power_model: the power model
+ *
+ * @return the power model name
+ */
+std::string PowerMeter::getPowerModelName(PowerModel power_model) {
+    switch (power_model) {
+        case TRADITIONAL:
+            return "traditional";
+        case PAIRWISE:
+            return "pairwise";
+        case UNPAIRED:
+            return "unpaired";
+    }
+    throw std::invalid_argument("PowerMeter::getPowerModelName(): unknown power model");
+}
+
 /**
  * @brief Compare the start time between two workflow tasks
  *
@@ -67,6 +131,13 @@ int PowerMeter::main() {
 
     WRENCH_INFO("New Power Meter starting (%s)", this->mailbox_name.c_str());
 
+    // energy is integrated on task notifications, so there is no need to wake up periodically
+    if (this->integration_mode == ANALYTIC) {
+        while (this->processNextMessage(-1)) {}
+        WRENCH_INFO("Energy Meter Manager terminating");
+        return 0;
+    }
+
     /** Main loop **/
     while (true) {
         wrench::S4U_Simulation::computeZeroFlop();
@@ -74,34 +145,22 @@ int PowerMeter::main() {
         double current_time = wrench::Simulation::getCurrentSimulatedDate();
 
         if (current_time >= this->time_to_next_measurement) {
-            // separate tasks per host
-            std::map<std::string, std::set<wrench::WorkflowTask *>> tasks_per_host;
-
-            for (auto task : this->wms->getWorkflow()->getTasks()) {
-
-                // only process running tasks
-                if (task->getStartDate() != -1 && task->getEndDate() == -1) {
-                    if (tasks_per_host.find(task->getExecutionHost()) == tasks_per_host.end()) {
-                        std::set<wrench::WorkflowTask *> tasks_set;
-                        tasks_set.insert(task);
-                        tasks_per_host.insert(std::make_pair(task->getExecutionHost(), tasks_set));
-                    } else {
-                        tasks_per_host[task->getExecutionHost()].insert(task);
-                    }
-                }
-            }
-
-            // compute power consumption
-            for (auto &key_value : tasks_per_host) {
-                this->computePowerMeasurements(key_value.first, key_value.second);
-            }
+            this->computePowerMeasurements();
 
             // update time to next measurement
             this->time_to_next_measurement = current_time + this->measurement_period;
         }
 
+        // when nothing is metered, adaptive sampling sleeps until a task is dispatched
+        double timeout = this->measurement_period;
+        if (this->integration_mode == ADAPTIVE_SAMPLING && this->active_hosts.empty() &&
+            this->recorded_hosts.empty()) {
+            this->sleeping = true;
+            timeout = -1;
+        }
+
         // stop meter
-        if (!this->processNextMessage(this->measurement_period)) {
+        if (!this->processNextMessage(timeout)) {
             break;
         }
     }
@@ -111,71 +170,344 @@ int PowerMeter::main() {
 }
 
 /**
- * @brief Obtain the current power consumption of a host and will add SimulationTimestampEnergyConsumption to
- *          simulation output if can_record is set to true
+ * @brief Notify the power meter that a task has been dispatched to a metered host
+ *
+ * @param task: the workflow task
+ * @param hostname: the physical host on which the task will run
  *
+ * @throw std::invalid_argument
+ */
+void PowerMeter::notifyTaskStart(wrench::WorkflowTask *task, const std::string &hostname) {
+    auto host_it = this->host_ids.find(hostname);
+    if (host_it == this->host_ids.end()) {
+        throw std::invalid_argument("PowerMeter::notifyTaskStart(): host " + hostname + " is not metered");
+    }
+    auto host_id = host_it->second;
+
+    if (this->integration_mode == ANALYTIC) {
+        this->integrateEnergyConsumption(host_id, wrench::Simulation::getCurrentSimulatedDate());
+    }
+    this->tasks_per_host[host_id].insert(task);
+    this->active_hosts.insert(host_id);
+    this->task_host_map[task] = host_id;
+
+    if (this->sleeping) {
+        this->sleeping = false;
+        wrench::S4U_Mailbox::dputMessage(this->mailbox_name, new PowerMeterWakeUpMessage());
+    }
+}
+
+/**
+ * @brief Notify the power meter that a task has completed, so it is no longer metered
+ *
+ * @param task: the workflow task
+ */
+void PowerMeter::notifyTaskCompletion(wrench::WorkflowTask *task) {
+    auto it = this->task_host_map.find(task);
+    if (it == this->task_host_map.end()) {
+        return;
+    }
+    auto host_id = it->second;
+
+    if (this->integration_mode == ANALYTIC) {
+        this->integrateEnergyConsumption(host_id, wrench::Simulation::getCurrentSimulatedDate());
+    }
+    this->tasks_per_host[host_id].erase(task);
+    if (this->tasks_per_host[host_id].empty()) {
+        this->active_hosts.erase(host_id);
+    }
+    this->task_host_map.erase(it);
+}
+
+/**
+ * @brief Get the integration mode of the power meter
+ *
+ * @return the integration mode
+ */
+PowerMeter::IntegrationMode PowerMeter::getIntegrationMode() const {
+    return this->integration_mode;
+}
+
+/**
+ * @brief Get the metered hosts
+ *
+ * @return the hostnames, in host ID order
+ */
+const std::vector<std::string> &PowerMeter::getHostnames() const {
+    return this->host_table.hostnames;
+}
+
+/**
+ * @brief Get the energy consumed so far by a host according to a power model
+ *
+ * @param power_model: the power model
  * @param hostname: the host name
- * @param tasks: list of WorkflowTask running on the host
- * @param record_as_time_stamp: bool signaling whether or not to record a SimulationTimestampEnergyConsumption object
+ *
+ * @return the host energy consumption (in Wh)
  *
  * @throw std::invalid_argument
  */
-void PowerMeter::computePowerMeasurements(const std::string &hostname,
-                                          std::set<wrench::WorkflowTask *> &tasks) {
-    int task_index = 0;
-    double task_factor = 1;
-    double consumption = wrench::S4U_Simulation::getMinPowerConsumption(hostname);
+double PowerMeter::getEnergyConsumption(PowerModel power_model, const std::string &hostname) {
+    auto model_it = std::find(this->power_models.begin(), this->power_models.end(), power_model);
+    if (model_it == this->power_models.end()) {
+        throw std::invalid_argument("PowerMeter::getEnergyConsumption(): power model " +
+                                    getPowerModelName(power_model) + " is not evaluated by this meter");
+    }
+    auto host_it = this->host_ids.find(hostname);
+    if (host_it == this->host_ids.end()) {
+        throw std::invalid_argument("PowerMeter::getEnergyConsumption(): unknown host " + hostname);
+    }
+    return this->energy_per_model.at(model_it - this->power_models.begin()).at(host_it->second).getValue();
+}
 
+/**
+ * @brief Integrate the energy consumption of a host up to a given date. The host power is piecewise
+ *        constant between task start and end dates, so the integral is exact.
+ *
+ * @param host_id: the host ID
+ * @param until: the date up to which energy should be integrated
+ */
+void PowerMeter::integrateEnergyConsumption(std::size_t host_id, double until) {
+    Profiler::Scope profiler_scope(Profiler::INTEGRATE_ENERGY_CONSUMPTION);
+    double from = this->integrated_until[host_id];
+    this->integrated_until[host_id] = until;
+
+    auto &tasks = this->tasks_per_host[host_id];
+    if (tasks.empty() || until <= from) {
+        return;
+    }
+
+    // dates at which the set of running tasks changes
+    std::vector<double> dates = {from, until};
     for (auto task : tasks) {
-        double task_consumption;
+        for (double date : {task->getStartDate(), task->getEndDate()}) {
+            if (date > from && date < until) {
+                dates.push_back(date);
+            }
+        }
+    }
+    std::sort(dates.begin(), dates.end());
+    dates.erase(std::unique(dates.begin(), dates.end()), dates.end());
+
+    for (std::size_t i = 0; i + 1 < dates.size(); i++) {
+        double mid = (dates[i] + dates[i + 1]) / 2;
+        std::set<wrench::WorkflowTask *> running_tasks;
+        for (auto task : tasks) {
+            if (task->getStartDate() != -1 && task->getStartDate() <= mid &&
+                (task->getEndDate() == -1 || task->getEndDate() > mid)) {
+                running_tasks.insert(task);
+            }
+        }
+        if (running_tasks.empty()) {
+            continue;
+        }
+        this->aggregateHostActivity(host_id, running_tasks);
+        this->computePowerConsumption(host_id, host_id + 1);
+        for (std::size_t m = 0; m < this->power_models.size(); m++) {
+            this->energy_per_model[m][host_id].add(
+                    this->power_per_model[m][host_id] * (dates[i + 1] - dates[i]) / 3600.0);
+        }
+    }
+}
+
+/**
+ * @brief Obtain the current power consumption of every host with running tasks for every power model,
+ *        accumulate the energy consumed over one measurement period, and record the measurements in
+ *        the energy trace store (if any)
+ */
+void PowerMeter::computePowerMeasurements() {
+    Profiler::Scope profiler_scope(Profiler::COMPUTE_POWER_MEASUREMENTS);
+    auto &num_tasks = this->host_activity.num_tasks;
+    std::fill(num_tasks.begin(), num_tasks.end(), 0.0);
+    std::fill(this->host_activity.pairwise_cpu_load.begin(), this->host_activity.pairwise_cpu_load.end(), 0.0);
+    std::fill(this->host_activity.unpaired_cpu_load.begin(), this->host_activity.unpaired_cpu_load.end(), 0.0);
+
+    // only process running tasks
+    std::set<wrench::WorkflowTask *> running_tasks;
+    for (auto host_id : this->active_hosts) {
+        running_tasks.clear();
+        for (auto task : this->tasks_per_host[host_id]) {
+            if (task->getStartDate() != -1 && task->getEndDate() == -1) {
+                running_tasks.insert(task);
+            }
+        }
+        this->aggregateHostActivity(host_id, running_tasks);
+    }
 
-        if (this->traditional) {
-            task_consumption = (wrench::Simulation::getMaxPowerConsumption(hostname) -
-                                wrench::Simulation::getMinPowerConsumption(hostname)) /
-                               double(wrench::Simulation::getHostNumCores(hostname));
+    // compute power consumption for all hosts at once
+    this->computePowerConsumption(0, num_tasks.size());
 
-        } else {
-            // power related to cpu usage
-            // dynamic power per socket
-            double dynamic_power =
-                    (wrench::Simulation::getMaxPowerConsumption(hostname) -
-                     wrench::Simulation::getMinPowerConsumption(hostname)) *
-                    (task->getAverageCPU() / 100) / 2;
-
-            if (this->pairwise && task_index < 2) {
-                task_consumption = dynamic_power / 6;
-
-            } else if (this->pairwise && task_index >= 2) {
-                task_consumption = task_factor * (dynamic_power / 6);
-                task_factor *= 0.88;
-
-            } else if (not this->pairwise && std::fmod(task_index, 6) == 0) {
-                task_consumption = dynamic_power / 6;
-                task_factor = 1;
-
-            } else {
-                task_consumption = task_factor * (dynamic_power / 6);
-                task_factor *= 0.9;
+    double date = wrench::Simulation::getCurrentSimulatedDate();
+    for (auto host_id : this->active_hosts) {
+        if (num_tasks[host_id] > 0) {
+            // a measurement holds for one measurement period
+            for (std::size_t m = 0; m < this->power_models.size(); m++) {
+                this->energy_per_model[m][host_id].add(
+                        this->power_per_model[m][host_id] * this->measurement_period / 3600.0);
             }
+            this->recordPowerMeasurements(host_id, date);
+        }
+    }
 
-            // power related to IO usage
-            task_consumption += task_consumption * (this->pairwise ? 0.486 : 0.213);
+    // with adaptive sampling, a zero measurement marks that a host no longer runs tasks
+    if (this->integration_mode == ADAPTIVE_SAMPLING) {
+        for (auto it = this->recorded_hosts.begin(); it != this->recorded_hosts.end();) {
+            auto host_id = *it++;
+            if (num_tasks[host_id] == 0) {
+                for (std::size_t m = 0; m < this->power_models.size(); m++) {
+                    this->power_per_model[m][host_id] = 0;
+                }
+                this->recordPowerMeasurements(host_id, date);
+            }
+        }
+    }
+}
 
-            // IOWait factor
-            task_consumption *= 1.31;
-            task_index++;
+/**
+ * @brief Record the power consumption of a host for every power model in the energy trace store (if any). With
+ *        adaptive sampling, a measurement is only recorded if the power changed since the last recorded
+ *        measurement, or if the maximum sampling interval elapsed.
+ *
+ * @param host_id: the host ID
+ * @param date: the measurement date
+ */
+void PowerMeter::recordPowerMeasurements(std::size_t host_id, double date) {
+    bool adaptive = (this->integration_mode == ADAPTIVE_SAMPLING);
+    bool changed = (date - this->recorded_date[host_id] >= this->max_sampling_interval);
+    bool has_power = false;
+
+    for (std::size_t m = 0; m < this->power_models.size(); m++) {
+        changed |= (this->power_per_model[m][host_id] != this->recorded_power_per_model[m][host_id]);
+        has_power |= (this->power_per_model[m][host_id] > 0);
+    }
+    if (adaptive && !changed) {
+        return;
+    }
+
+    for (std::size_t m = 0; m < this->power_models.size(); m++) {
+        if (this->energy_trace) {
+            this->energy_trace->addMeasurement(date, this->trace_host_ids[host_id], this->trace_model_ids[m],
+                                               this->power_per_model[m][host_id]);
         }
+        this->recorded_power_per_model[m][host_id] = this->power_per_model[m][host_id];
+    }
+    this->recorded_date[host_id] = date;
 
-        consumption += task_consumption;
+    if (adaptive && has_power) {
+        this->recorded_hosts.insert(host_id);
+    } else {
+        this->recorded_hosts.erase(host_id);
     }
+}
 
-    std::string appended_hostname = (this->traditional ? "traditional" : this->pairwise ? "pairwise" : "unpaired");
+/**
+ * @brief Aggregate the running tasks of a host into the per-host activity arrays. Pairwise and
+ *        unpaired models weight each task CPU usage depending on its position within the socket.
+ *
+ * @param host_id: the host ID
+ * @param tasks: list of WorkflowTask running on the host
+ */
+void PowerMeter::aggregateHostActivity(std::size_t host_id, const std::set<wrench::WorkflowTask *> &tasks) {
+    int task_index = 0;
+    double pairwise_factor = 1;
+    double unpaired_factor = 1;
+    double pairwise_cpu_load = 0;
+    double unpaired_cpu_load = 0;
 
-    this->simulation->getOutput().addTimestampEnergyConsumption(appended_hostname + "__" + hostname, consumption);
+    for (auto task : tasks) {
+        double cpu_usage = task->getAverageCPU();
+
+        if (task_index < 2) {
+            pairwise_cpu_load += cpu_usage;
+        } else {
+            pairwise_cpu_load += pairwise_factor * cpu_usage;
+            pairwise_factor *= 0.88;
+        }
+
+        if (task_index % 6 == 0) {
+            unpaired_cpu_load += cpu_usage;
+            unpaired_factor = 1;
+        } else {
+            unpaired_cpu_load += unpaired_factor * cpu_usage;
+            unpaired_factor *= 0.9;
+        }
+        task_index++;
+    }
+
+    this->host_activity.num_tasks[host_id] = tasks.size();
+    this->host_activity.pairwise_cpu_load[host_id] = pairwise_cpu_load;
+    this->host_activity.unpaired_cpu_load[host_id] = unpaired_cpu_load;
+}
+
+/**
+ * @brief Compute the power consumption of a range of hosts for every power model, from the host
+ *        power table and the per-host activity arrays
+ *
+ * @param first_host_id: ID of the first host in the range
+ * @param last_host_id: ID past the last host in the range
+ */
+void PowerMeter::computePowerConsumption(std::size_t first_host_id, std::size_t last_host_id) {
+    // a task uses half of the dynamic power of a 6-core socket, plus IO usage and IOWait factors
+    const double pairwise_factor = (1 + 0.486) * 1.31 / (100 * 2 * 6);
+    const double unpaired_factor = (1 + 0.213) * 1.31 / (100 * 2 * 6);
+
+    const double *min_power = this->host_table.min_power.data();
+    const double *dynamic_power = this->host_table.dynamic_power.data();
+    const double *num_cores = this->host_table.num_cores.data();
+    const double *num_tasks = this->host_activity.num_tasks.data();
+    const double *pairwise_cpu_load = this->host_activity.pairwise_cpu_load.data();
+    const double *unpaired_cpu_load = this->host_activity.unpaired_cpu_load.data();
+
+    for (std::size_t m = 0; m < this->power_models.size(); m++) {
+        double *power = this->power_per_model[m].data();
+
+        switch (this->power_models[m]) {
+            case TRADITIONAL:
+                for (std::size_t h = first_host_id; h < last_host_id; h++) {
+                    power[h] = min_power[h] + num_tasks[h] * dynamic_power[h] / num_cores[h];
+                }
+                break;
+            case PAIRWISE:
+                for (std::size_t h = first_host_id; h < last_host_id; h++) {
+                    power[h] = min_power[h] + pairwise_factor * dynamic_power[h] * pairwise_cpu_load[h];
+                }
+                break;
+            case UNPAIRED:
+                for (std::size_t h = first_host_id; h < last_host_id; h++) {
+                    power[h] = min_power[h] + unpaired_factor * dynamic_power[h] * unpaired_cpu_load[h];
+                }
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Add a value to the accumulator
+ *
+ * @param value: the value to add
+ */
+void PowerMeter::EnergyAccumulator::add(double value) {
+    double total = this->sum + value;
+    if (std::fabs(this->sum) >= std::fabs(value)) {
+        this->compensation += (this->sum - total) + value;
+    } else {
+        this->compensation += (value - total) + this->sum;
+    }
+    this->sum = total;
+}
+
+/**
+ * @brief Get the compensated value of the accumulator
+ *
+ * @return the accumulated value
+ */
+double PowerMeter::EnergyAccumulator::getValue() const {
+    return this->sum + this->compensation;
 }
 
 /**
  * @brief Process the next message
+ * @param timeout: the time to wait for a message (a negative value means no timeout)
  * @return true if the daemon should continue, false otherwise
  *
  * @throw std::runtime_error
@@ -184,7 +516,11 @@ bool PowerMeter::processNextMessage(double timeout) {
     std::shared_ptr<wrench::SimulationMessage> message = nullptr;
 
     try {
-        message = wrench::S4U_Mailbox::getMessage(this->mailbox_name, timeout);
+        if (timeout < 0) {
+            message = wrench::S4U_Mailbox::getMessage(this->mailbox_name);
+        } else {
+            message = wrench::S4U_Mailbox::getMessage(this->mailbox_name, timeout);
+        }
     } catch (std::shared_ptr<wrench::NetworkError> &cause) {
         return true;
     }
@@ -199,6 +535,9 @@ bool PowerMeter::processNextMessage(double timeout) {
         // There shouldn't be any need to clean any state up
         return false;
 
+    } else if (auto msg = dynamic_cast<PowerMeterWakeUpMessage *>(message.get())) {
+        return true;
+
     } else {
         throw std::runtime_error(
                 "PowerMeter::waitForNextMessage(): Unexpected [" + message->getName() + "] message");
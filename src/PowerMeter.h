@@ -10,18 +10,60 @@
 #ifndef ENERGY_AWARE_POWERMETER_H
 #define ENERGY_AWARE_POWERMETER_H
 
+#include <unordered_map>
 #include <wrench-dev.h>
 
+#include "EnergyTraceStore.h"
+
+/**
+ * @brief A message sent to a sleeping power meter when a task is dispatched to a metered host
+ */
+class PowerMeterWakeUpMessage : public wrench::SimulationMessage {
+public:
+    PowerMeterWakeUpMessage() : wrench::SimulationMessage("PowerMeterWakeUpMessage", 0) {}
+};
+
 class PowerMeter : public wrench::Service {
 public:
+    /** @brief Power models that can be evaluated by the meter */
+    enum PowerModel {
+        TRADITIONAL,
+        PAIRWISE,
+        UNPAIRED
+    };
+
+    /** @brief How the meter turns power into energy */
+    enum IntegrationMode {
+        /** @brief Periodically sample the power of every host */
+        SAMPLING,
+        /** @brief Periodically observe every host, but only record power values that changed */
+        ADAPTIVE_SAMPLING,
+        /** @brief Integrate the piecewise-constant power exactly between task start/end events */
+        ANALYTIC
+    };
+
     PowerMeter(wrench::WMS *wms,
                const std::vector<std::string> &hostnames,
                double period,
-               bool traditional = true,
-               bool pairwise = false);
+               std::shared_ptr<EnergyTraceStore> energy_trace = nullptr,
+               const std::vector<PowerModel> &power_models = {TRADITIONAL},
+               IntegrationMode integration_mode = SAMPLING,
+               double max_sampling_interval = 60);
+
+    static std::string getPowerModelName(PowerModel power_model);
 
     void stop() override;
 
+    void notifyTaskStart(wrench::WorkflowTask *task, const std::string &hostname);
+
+    void notifyTaskCompletion(wrench::WorkflowTask *task);
+
+    IntegrationMode getIntegrationMode() const;
+
+    const std::vector<std::string> &getHostnames() const;
+
+    double getEnergyConsumption(PowerModel power_model, const std::string &hostname);
+
 private:
     int main() override;
 
@@ -29,15 +71,65 @@ private:
         bool operator()(wrench::WorkflowTask *&lhs, wrench::WorkflowTask *&rhs);
     };
 
-    void computePowerMeasurements(const std::string &hostname, std::set<wrench::WorkflowTask *> &tasks);
+    /** @brief Per-host power constants, resolved once and indexed by host ID (struct-of-arrays) */
+    struct HostPowerTable {
+        std::vector<std::string> hostnames;
+        std::vector<double> min_power;
+        std::vector<double> dynamic_power;
+        std::vector<double> num_cores;
+    };
+
+    /** @brief Per-host aggregates of the running tasks, indexed by host ID (struct-of-arrays) */
+    struct HostActivity {
+        std::vector<double> num_tasks;
+        std::vector<double> pairwise_cpu_load;
+        std::vector<double> unpaired_cpu_load;
+    };
+
+    /** @brief A running sum with Neumaier compensation of the rounding error */
+    struct EnergyAccumulator {
+        double sum = 0;
+        double compensation = 0;
+
+        void add(double value);
+
+        double getValue() const;
+    };
+
+    void computePowerMeasurements();
+
+    void recordPowerMeasurements(std::size_t host_id, double date);
+
+    void aggregateHostActivity(std::size_t host_id, const std::set<wrench::WorkflowTask *> &tasks);
+
+    void computePowerConsumption(std::size_t first_host_id, std::size_t last_host_id);
+
+    void integrateEnergyConsumption(std::size_t host_id, double until);
 
     bool processNextMessage(double timeout);
 
     wrench::WMS *wms;
-    bool traditional;
-    bool pairwise;
+    HostPowerTable host_table;
+    HostActivity host_activity;
+    std::unordered_map<std::string, std::size_t> host_ids;
+    std::vector<std::set<wrench::WorkflowTask *>> tasks_per_host;
+    std::set<std::size_t> active_hosts;
+    std::unordered_map<wrench::WorkflowTask *, std::size_t> task_host_map;
+    std::vector<PowerModel> power_models;
+    std::vector<std::vector<double>> power_per_model;
+    std::shared_ptr<EnergyTraceStore> energy_trace;
+    std::vector<unsigned int> trace_host_ids;
+    std::vector<unsigned int> trace_model_ids;
+    IntegrationMode integration_mode;
+    std::vector<std::vector<EnergyAccumulator>> energy_per_model;
+    std::vector<double> integrated_until;
     double measurement_period;
+    double max_sampling_interval;
     double time_to_next_measurement;
+    std::vector<std::vector<double>> recorded_power_per_model;
+    std::vector<double> recorded_date;
+    std::set<std::size_t> recorded_hosts;
+    bool sleeping;
 };
 
 #endif //ENERGY_AWARE_POWERMETER_H
@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2020-2021. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "Profiler.h"
+
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+bool Profiler::enabled = false;
+uint64_t Profiler::paused_time = 0;
+std::array<Profiler::ComponentStatistics, Profiler::NUM_COMPONENTS> Profiler::statistics;
+
+static const char *COMPONENT_NAMES[Profiler::NUM_COMPONENTS] = {
+        "EnergyAwareStandardJobScheduler::scheduleTasks",
+        "SchedulingAlgorithm::sortTasks",
+        "SchedulingAlgorithm::scheduleTask",
+        "CostModel::estimateCosts",
+        "PowerMeter::computePowerMeasurements",
+        "PowerMeter::integrateEnergyConsumption",
+        "main(): energy aggregation",
+        "main(): energy trace dump"
+};
+
+/**
+ * @brief Format a latency in nanoseconds with a readable unit
+ *
+ * @param latency: latency (ns)
+ *
+ * @return the formatted latency
+ */
+static std::string formatLatency(double latency) {
+    std::ostringstream formatted;
+    formatted << std::fixed << std::setprecision(latency < 1e3 ? 0 : 1);
+    if (latency < 1e3) {
+        formatted << latency << " ns";
+    } else if (latency < 1e6) {
+        formatted << latency / 1e3 << " us";
+    } else if (latency < 1e9) {
+        formatted << latency / 1e6 << " ms";
+    } else {
+        formatted << latency / 1e9 << " s";
+    }
+    return formatted.str();
+}
+
+/**
+ * @brief Enable profiling
+ */
+void Profiler::enable() {
+    Profiler::enabled = true;
+}
+
+/**
+ * @brief Check whether profiling is enabled
+ *
+ * @return true if profiling is enabled
+ */
+bool Profiler::isEnabled() {
+    return Profiler::enabled;
+}
+
+/**
+ * @brief Record a call of a component
+ *
+ * @param component: the component
+ * @param latency: the wall-clock latency of the call (ns)
+ */
+void Profiler::record(Component component, uint64_t latency) {
+    auto &component_statistics = Profiler::statistics[component];
+    component_statistics.num_calls++;
+    component_statistics.total_latency += latency;
+    if (latency > component_statistics.max_latency) {
+        component_statistics.max_latency = latency;
+    }
+
+    int bucket = 0;
+    while (latency >>= 1) {
+        bucket++;
+    }
+    component_statistics.histogram[bucket]++;
+}
+
+/**
+ * @brief Print the per-component breakdown, with latency histograms
+ *
+ * @param output: the output stream
+ */
+void Profiler::report(std::ostream &output) {
+    output << "Profile (wall-clock time, excluding requests to simulated services):" << std::endl;
+    for (int c = 0; c < NUM_COMPONENTS; c++) {
+        auto &component_statistics = Profiler::statistics[c];
+        if (component_statistics.num_calls == 0) {
+            continue;
+        }
+        output << "  " << COMPONENT_NAMES[c] << ": " << component_statistics.num_calls << " calls, total "
+               << formatLatency(component_statistics.total_latency) << ", mean "
+               << formatLatency((double) component_statistics.total_latency / component_statistics.num_calls)
+               << ", max " << formatLatency(component_statistics.max_latency) << std::endl;
+
+        for (int b = 0; b < NUM_BUCKETS; b++) {
+            auto count = component_statistics.histogram[b];
+            if (count == 0) {
+                continue;
+            }
+            output << "    [" << std::setw(8) << formatLatency(std::ldexp(1.0, b)) << ", " << std::setw(8)
+                   << formatLatency(std::ldexp(1.0, b + 1)) << "): " << std::setw(10) << count << " "
+                   << std::string((std::size_t) std::ceil(40.0 * count / component_statistics.num_calls), '#')
+                   << std::endl;
+        }
+    }
+}
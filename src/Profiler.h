@@ -0,0 +1,124 @@
+/**
+ * Copyright (c) 2020-2021. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef ENERGY_AWARE_PROFILER_H
+#define ENERGY_AWARE_PROFILER_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+/**
+ * @brief A low-overhead self-profiler of the simulator hot paths, which keeps call counters and
+ *        log2 histograms of the wall-clock latency of each call. Profiling is disabled by default.
+ */
+class Profiler {
+public:
+    /** @brief Profiled components */
+    enum Component {
+        SCHEDULE_TASKS,
+        SORT_TASKS,
+        SCHEDULE_TASK,
+        ESTIMATE_COST,
+        COMPUTE_POWER_MEASUREMENTS,
+        INTEGRATE_ENERGY_CONSUMPTION,
+        ENERGY_AGGREGATION,
+        TRACE_DUMP,
+        NUM_COMPONENTS
+    };
+
+    /**
+     * @brief A scoped timer, which records the latency of the enclosing scope (if profiling is enabled),
+     *        excluding the time spent in pauses
+     */
+    class Scope {
+    public:
+        explicit Scope(Component component) : component(component), enabled(Profiler::enabled) {
+            if (this->enabled) {
+                this->start = std::chrono::steady_clock::now();
+                this->paused_time_at_start = Profiler::paused_time;
+            }
+        }
+
+        ~Scope() {
+            if (this->enabled) {
+                uint64_t latency = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - this->start).count();
+                uint64_t paused_time = Profiler::paused_time - this->paused_time_at_start;
+                Profiler::record(this->component, latency > paused_time ? latency - paused_time : 0);
+            }
+        }
+
+        Scope(const Scope &) = delete;
+
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        Component component;
+        bool enabled;
+        std::chrono::steady_clock::time_point start;
+        uint64_t paused_time_at_start = 0;
+    };
+
+    /**
+     * @brief A scoped pause of the enclosing timers, around calls that block the calling actor (e.g.,
+     *        requests to WRENCH services) while other actors, which have their own timers, run
+     */
+    class Pause {
+    public:
+        Pause() : enabled(Profiler::enabled) {
+            if (this->enabled) {
+                this->start = std::chrono::steady_clock::now();
+            }
+        }
+
+        ~Pause() {
+            if (this->enabled) {
+                Profiler::paused_time += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - this->start).count();
+            }
+        }
+
+        Pause(const Pause &) = delete;
+
+        Pause &operator=(const Pause &) = delete;
+
+    private:
+        bool enabled;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    static void enable();
+
+    static bool isEnabled();
+
+    static void record(Component component, uint64_t latency);
+
+    static void report(std::ostream &output);
+
+private:
+    /** @brief Number of histogram buckets: bucket b counts latencies in [2^b, 2^(b+1)) ns */
+    static const int NUM_BUCKETS = 64;
+
+    /** @brief Statistics of a component */
+    struct ComponentStatistics {
+        uint64_t num_calls = 0;
+        uint64_t total_latency = 0;
+        uint64_t max_latency = 0;
+        std::array<uint64_t, NUM_BUCKETS> histogram{};
+    };
+
+    static bool enabled;
+    /** @brief Total time spent in pauses (ns) */
+    static uint64_t paused_time;
+    static std::array<ComponentStatistics, NUM_COMPONENTS> statistics;
+};
+
+#endif //ENERGY_AWARE_PROFILER_H
@@ -0,0 +1,187 @@
+/**
+ * Copyright (c) 2020-2021. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "ResultCache.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <simgrid/version.h>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include <wrench-dev.h>
+
+#ifndef ENERGY_AWARE_VERSION
+#define ENERGY_AWARE_VERSION "unknown"
+#endif
+
+static const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+static const uint64_t FNV_PRIME = 1099511628211ULL;
+
+/**
+ * @brief Update a 64-bit FNV-1a hash with a buffer
+ *
+ * @param hash: the hash
+ * @param data: the buffer
+ * @param size: the buffer size
+ */
+static void hashBytes(uint64_t &hash, const char *data, std::size_t size) {
+    for (std::size_t i = 0; i < size; i++) {
+        hash ^= (unsigned char) data[i];
+        hash *= FNV_PRIME;
+    }
+}
+
+/**
+ * @brief Update a 64-bit FNV-1a hash with a length-prefixed string
+ *
+ * @param hash: the hash
+ * @param value: the string
+ */
+static void hashString(uint64_t &hash, const std::string &value) {
+    uint64_t size = value.size();
+    hashBytes(hash, (const char *) &size, sizeof(size));
+    hashBytes(hash, value.data(), value.size());
+}
+
+/**
+ * @brief Update a 64-bit FNV-1a hash with the contents and size of a file
+ *
+ * @param hash: the hash
+ * @param file_path: path to the file
+ *
+ * @return false if the file cannot be opened
+ */
+static bool hashFile(uint64_t &hash, const std::string &file_path) {
+    std::ifstream input(file_path, std::ios::binary);
+    if (!input) {
+        return false;
+    }
+    std::vector<char> buffer(1 << 20);
+    uint64_t size = 0;
+    while (input.read(buffer.data(), buffer.size()) || input.gcount() > 0) {
+        hashBytes(hash, buffer.data(), input.gcount());
+        size += input.gcount();
+    }
+    hashBytes(hash, (const char *) &size, sizeof(size));
+    return true;
+}
+
+/**
+ * @brief Constructor
+ *
+ * @param cache_dir: the directory holding the cache entries (created if needed)
+ *
+ * @throw std::runtime_error
+ */
+ResultCache::ResultCache(std::string cache_dir) : cache_dir(std::move(cache_dir)) {
+    if (mkdir(this->cache_dir.c_str(), 0755) != 0 && errno != EEXIST) {
+        throw std::runtime_error("ResultCache::ResultCache(): cannot create cache directory " + this->cache_dir);
+    }
+}
+
+/**
+ * @brief Compute the cache key of a simulation from the contents of its input files, its parameters,
+ *        and the simulator build (the contents of the running executable and the versions of the WRENCH and
+ *        SimGrid libraries it is linked with, so that a rebuilt simulator or upgraded libraries never return
+ *        results cached by a previous build)
+ *
+ * @param input_files: paths to the input files (e.g., platform and workflow)
+ * @param parameters: the simulation parameters, by name
+ *
+ * @return the cache key, as a hexadecimal string
+ *
+ * @throw std::invalid_argument
+ * @throw std::runtime_error
+ */
+std::string ResultCache::computeKey(const std::vector<std::string> &input_files,
+                                    const std::map<std::string, std::string> &parameters) {
+    uint64_t hash = FNV_OFFSET_BASIS;
+    hashString(hash, ENERGY_AWARE_VERSION);
+    if (!hashFile(hash, "/proc/self/exe")) {
+        throw std::runtime_error("ResultCache::computeKey(): cannot read the simulator executable");
+    }
+    int simgrid_major, simgrid_minor, simgrid_patch;
+    sg_version_get(&simgrid_major, &simgrid_minor, &simgrid_patch);
+    hashString(hash, wrench::Simulation::getWRENCHVersion());
+    hashString(hash, std::to_string(simgrid_major) + "." + std::to_string(simgrid_minor) + "." +
+                     std::to_string(simgrid_patch));
+
+    for (auto const &file : input_files) {
+        if (!hashFile(hash, file)) {
+            throw std::invalid_argument("ResultCache::computeKey(): cannot open " + file);
+        }
+    }
+
+    for (auto const &parameter : parameters) {
+        hashString(hash, parameter.first);
+        hashString(hash, parameter.second);
+    }
+
+    char key[17];
+    std::snprintf(key, sizeof(key), "%016llx", (unsigned long long) hash);
+    return key;
+}
+
+/**
+ * @brief Look up the results of a simulation
+ *
+ * @param key: the cache key
+ * @param results: the cached results (if found)
+ *
+ * @return true if the results were found in the cache
+ */
+bool ResultCache::lookup(const std::string &key, std::string &results) const {
+    std::ifstream input(this->getEntryPath(key));
+    if (!input) {
+        return false;
+    }
+    std::stringstream content;
+    content << input.rdbuf();
+    results = content.str();
+    return true;
+}
+
+/**
+ * @brief Store the results of a simulation. The entry is written to a temporary file first and then
+ *        renamed, so that concurrent simulations never observe a partial entry.
+ *
+ * @param key: the cache key
+ * @param results: the results to store
+ */
+void ResultCache::store(const std::string &key, const std::string &results) const {
+    auto path = this->getEntryPath(key);
+    auto tmp_path = path + ".tmp." + std::to_string(getpid());
+    {
+        std::ofstream output(tmp_path, std::ios::trunc);
+        output << results;
+        if (!output) {
+            std::remove(tmp_path.c_str());
+            return;
+        }
+    }
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+    }
+}
+
+/**
+ * @brief Get the path of a cache entry
+ *
+ * @param key: the cache key
+ *
+ * @return the path of the cache entry
+ */
+std::string ResultCache::getEntryPath(const std::string &key) const {
+    return this->cache_dir + "/" + key + ".csv";
+}
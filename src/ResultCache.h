@@ -0,0 +1,38 @@
+/**
+ * Copyright (c) 2020-2021. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef ENERGY_AWARE_RESULTCACHE_H
+#define ENERGY_AWARE_RESULTCACHE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief An on-disk cache of simulation results, keyed by a hash of the simulation inputs
+ *        and of the simulator version
+ */
+class ResultCache {
+public:
+    explicit ResultCache(std::string cache_dir);
+
+    static std::string computeKey(const std::vector<std::string> &input_files,
+                                  const std::map<std::string, std::string> &parameters);
+
+    bool lookup(const std::string &key, std::string &results) const;
+
+    void store(const std::string &key, const std::string &results) const;
+
+private:
+    std::string getEntryPath(const std::string &key) const;
+
+    std::string cache_dir;
+};
+
+#endif //ENERGY_AWARE_RESULTCACHE_H
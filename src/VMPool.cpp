@@ -0,0 +1,139 @@
+/**
+ * Copyright (c) 2020-2021. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "VMPool.h"
+
+#include <stdexcept>
+
+/**
+ * @brief Constructor
+ *
+ * @param keep_alive_timeout: how long an idle VM is kept running (0 disables the pool)
+ * @param max_idle_vms_per_host: maximum number of idle VMs kept running on a host
+ *
+ * @throw std::invalid_argument
+ */
+VMPool::VMPool(double keep_alive_timeout, unsigned long max_idle_vms_per_host) :
+        keep_alive_timeout(keep_alive_timeout), max_idle_vms_per_host(max_idle_vms_per_host), num_hits(0),
+        num_misses(0) {
+    if (this->keep_alive_timeout < 0) {
+        throw std::invalid_argument("VMPool::VMPool(): keep-alive timeout cannot be negative");
+    }
+}
+
+/**
+ * @brief Check whether idle VMs are kept warm
+ *
+ * @return true if the keep-alive timeout is positive and hosts can keep idle VMs
+ */
+bool VMPool::isEnabled() const {
+    return this->keep_alive_timeout > 0 && this->max_idle_vms_per_host > 0;
+}
+
+/**
+ * @brief Get the keep-alive timeout
+ *
+ * @return the timeout (in seconds)
+ */
+double VMPool::getKeepAliveTimeout() const {
+    return this->keep_alive_timeout;
+}
+
+/**
+ * @brief Check whether a VM is idle in the pool
+ *
+ * @param vm_name: the VM name
+ *
+ * @return true if the VM is kept warm by the pool
+ */
+bool VMPool::isIdle(const std::string &vm_name) const {
+    return this->idle_vms.find(vm_name) != this->idle_vms.end();
+}
+
+/**
+ * @brief Offer a VM that just went idle to the pool
+ *
+ * @param vm_name: the VM name
+ * @param hostname: the physical host of the VM
+ * @param date: the current date
+ *
+ * @return true if the VM is kept warm until date + keep-alive timeout, false if it should be shut down
+ */
+bool VMPool::release(const std::string &vm_name, const std::string &hostname, double date) {
+    if (!this->isEnabled()) {
+        return false;
+    }
+    auto &num_idle_vms = this->num_idle_vms_per_host[hostname];
+    if (num_idle_vms >= this->max_idle_vms_per_host) {
+        return false;
+    }
+    num_idle_vms++;
+    this->idle_vms[vm_name] = {hostname, date + this->keep_alive_timeout};
+    return true;
+}
+
+/**
+ * @brief Record that a job was dispatched to a VM, which leaves the pool (a pool hit) if it was idle in it
+ *
+ * @param vm_name: the VM name
+ */
+void VMPool::acquire(const std::string &vm_name) {
+    auto it = this->idle_vms.find(vm_name);
+    if (it == this->idle_vms.end()) {
+        return;
+    }
+    this->num_hits++;
+    this->num_idle_vms_per_host.at(it->second.hostname)--;
+    this->idle_vms.erase(it);
+}
+
+/**
+ * @brief Record that a job needed a VM to be created or restarted (a pool miss)
+ */
+void VMPool::notifyVMStart() {
+    this->num_misses++;
+}
+
+/**
+ * @brief Handle the end of a keep-alive timeout
+ *
+ * @param vm_name: the VM name
+ * @param date: the current date
+ *
+ * @return true if the VM has stayed idle for the whole timeout, and was removed from the pool so that it
+ *         can be shut down
+ */
+bool VMPool::expire(const std::string &vm_name, double date) {
+    auto it = this->idle_vms.find(vm_name);
+    // a VM reused then released again has a later expiration date
+    if (it == this->idle_vms.end() || date < it->second.expiration_date) {
+        return false;
+    }
+    this->num_idle_vms_per_host.at(it->second.hostname)--;
+    this->idle_vms.erase(it);
+    return true;
+}
+
+/**
+ * @brief Get the number of jobs dispatched to a VM kept warm by the pool
+ *
+ * @return number of pool hits
+ */
+unsigned long VMPool::getNumHits() const {
+    return this->num_hits;
+}
+
+/**
+ * @brief Get the number of jobs for which a VM had to be created or restarted
+ *
+ * @return number of pool misses
+ */
+unsigned long VMPool::getNumMisses() const {
+    return this->num_misses;
+}
@@ -0,0 +1,57 @@
+/**
+ * Copyright (c) 2020-2021. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef ENERGY_AWARE_VMPOOL_H
+#define ENERGY_AWARE_VMPOOL_H
+
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief A bounded pool of idle VMs kept warm for a keep-alive timeout, so that jobs dispatched shortly
+ *        after a VM goes idle reuse it instead of paying another VM shutdown and start
+ */
+class VMPool {
+public:
+    explicit VMPool(double keep_alive_timeout = 0, unsigned long max_idle_vms_per_host = 1);
+
+    bool isEnabled() const;
+
+    double getKeepAliveTimeout() const;
+
+    bool isIdle(const std::string &vm_name) const;
+
+    bool release(const std::string &vm_name, const std::string &hostname, double date);
+
+    void acquire(const std::string &vm_name);
+
+    void notifyVMStart();
+
+    bool expire(const std::string &vm_name, double date);
+
+    unsigned long getNumHits() const;
+
+    unsigned long getNumMisses() const;
+
+private:
+    /** @brief An idle VM kept warm */
+    struct IdleVM {
+        std::string hostname;
+        double expiration_date;
+    };
+
+    double keep_alive_timeout;
+    unsigned long max_idle_vms_per_host;
+    std::unordered_map<std::string, IdleVM> idle_vms;
+    std::unordered_map<std::string, unsigned long> num_idle_vms_per_host;
+    unsigned long num_hits;
+    unsigned long num_misses;
+};
+
+#endif //ENERGY_AWARE_VMPOOL_H
@@ -0,0 +1,217 @@
+/**
+ * Copyright (c) 2020-2021. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "WorkflowGenerator.h"
+
+#include <algorithm>
+
+static const std::string SPECIFICATION_PREFIX = "synthetic:";
+
+const std::vector<std::string> WorkflowGenerator::SHAPES = {"fork-join", "montage", "epigenomics"};
+
+/**
+ * @brief Check whether a workflow argument is a synthetic workflow specification
+ *
+ * @param specification: the workflow argument
+ *
+ * @return true if the argument starts with "synthetic:"
+ */
+bool WorkflowGenerator::isSyntheticWorkflow(const std::string &specification) {
+    return specification.rfind(SPECIFICATION_PREFIX, 0) == 0;
+}
+
+/**
+ * @brief Build a synthetic workflow specification
+ *
+ * @param shape: the DAG shape
+ * @param num_tasks: the (approximate) number of tasks
+ * @param seed: the seed of the task and file size generator
+ *
+ * @return the specification
+ */
+std::string WorkflowGenerator::getSpecification(const std::string &shape, unsigned long num_tasks,
+                                                unsigned long seed) {
+    return SPECIFICATION_PREFIX + shape + ":" + std::to_string(num_tasks) + ":" + std::to_string(seed);
+}
+
+/**
+ * @brief Constructor
+ *
+ * @param specification: "synthetic:<shape>:<number of tasks>[:<seed>]", where shape is fork-join,
+ *                       montage or epigenomics
+ *
+ * @throw std::invalid_argument
+ */
+WorkflowGenerator::WorkflowGenerator(const std::string &specification) : workflow(nullptr) {
+    if (!isSyntheticWorkflow(specification)) {
+        throw std::invalid_argument("WorkflowGenerator::WorkflowGenerator(): invalid specification " + specification);
+    }
+    std::vector<std::string> fields;
+    std::size_t begin = SPECIFICATION_PREFIX.size();
+    while (begin <= specification.size()) {
+        auto end = specification.find(':', begin);
+        if (end == std::string::npos) {
+            end = specification.size();
+        }
+        fields.push_back(specification.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    if (fields.size() < 2 || fields.size() > 3 ||
+        std::find(SHAPES.begin(), SHAPES.end(), fields[0]) == SHAPES.end()) {
+        throw std::invalid_argument("WorkflowGenerator::WorkflowGenerator(): invalid specification " + specification);
+    }
+
+    this->shape = fields[0];
+    this->num_tasks = std::stoul(fields[1]);
+    this->random_engine.seed(fields.size() == 3 ? std::stoul(fields[2]) : 0);
+    if (this->num_tasks < 10) {
+        throw std::invalid_argument("WorkflowGenerator::WorkflowGenerator(): at least 10 tasks are required");
+    }
+}
+
+/**
+ * @brief Generate the workflow
+ *
+ * @return the workflow
+ */
+wrench::Workflow *WorkflowGenerator::generate() {
+    this->workflow = new wrench::Workflow();
+    if (this->shape == "fork-join") {
+        this->generateForkJoin();
+    } else if (this->shape == "montage") {
+        this->generateMontage();
+    } else {
+        this->generateEpigenomics();
+    }
+    return this->workflow;
+}
+
+/**
+ * @brief Add a single-core task, with flops and average CPU usage drawn around the given means
+ *
+ * @param name: the task name (the task ID is the name followed by the task index)
+ * @param mean_flops: the mean number of flops
+ * @param mean_cpu: the mean CPU usage (percentage)
+ *
+ * @return the task
+ */
+wrench::WorkflowTask *WorkflowGenerator::addTask(const std::string &name, double mean_flops, double mean_cpu) {
+    std::uniform_real_distribution<double> variation(0.5, 1.5);
+    auto task = this->workflow->addTask(name + "_" + std::to_string(this->workflow->getNumberOfTasks()),
+                                        mean_flops * variation(this->random_engine), 1, 1, 0);
+    task->setAverageCPU(std::min(100.0, mean_cpu * variation(this->random_engine)));
+    return task;
+}
+
+/**
+ * @brief Make a file, drawn around the given mean size, flow from a parent task to a child task
+ *
+ * @param parent: the producer task
+ * @param child: the consumer task
+ * @param mean_size: the mean file size (bytes)
+ */
+void WorkflowGenerator::addDataDependency(wrench::WorkflowTask *parent, wrench::WorkflowTask *child,
+                                          double mean_size) {
+    std::uniform_real_distribution<double> variation(0.5, 1.5);
+    auto file = this->workflow->addFile(parent->getID() + "_" + child->getID(),
+                                        mean_size * variation(this->random_engine));
+    // the consumer is attached first, so that the data dependency is added once, by the producer
+    child->addInputFile(file);
+    parent->addOutputFile(file);
+}
+
+/**
+ * @brief A source task fanning out to independent tasks, joined by a sink task
+ */
+void WorkflowGenerator::generateForkJoin() {
+    auto source = this->addTask("fork", 1e10, 90);
+    std::vector<wrench::WorkflowTask *> branches;
+    for (unsigned long i = 0; i < this->num_tasks - 2; i++) {
+        branches.push_back(this->addTask("branch", 1e11, 80));
+    }
+    auto sink = this->addTask("join", 1e10, 90);
+
+    for (auto branch : branches) {
+        this->addDataDependency(source, branch, 1e7);
+        this->addDataDependency(branch, sink, 1e7);
+    }
+
+    auto input = this->workflow->addFile("fork_input", 1e8);
+    source->addInputFile(input);
+}
+
+/**
+ * @brief A Montage-like mosaic workflow: projections, overlap fitting between neighbors, a global
+ *        background model, background corrections, and a chain of co-addition tasks
+ */
+void WorkflowGenerator::generateMontage() {
+    unsigned long width = (this->num_tasks - 5) / 3;
+
+    auto concat_fit = this->addTask("mConcatFit", 5e10, 95);
+    auto bg_model = this->addTask("mBgModel", 2e11, 99);
+    this->addDataDependency(concat_fit, bg_model, 1e6);
+
+    std::vector<wrench::WorkflowTask *> projections;
+    for (unsigned long i = 0; i < width; i++) {
+        auto projection = this->addTask("mProject", 1.5e11, 98);
+        projection->addInputFile(this->workflow->addFile("image_" + std::to_string(i), 4e6));
+        projections.push_back(projection);
+    }
+
+    for (unsigned long i = 0; i + 1 < width; i++) {
+        auto diff_fit = this->addTask("mDiffFit", 2e10, 60);
+        this->addDataDependency(projections[i], diff_fit, 8e6);
+        this->addDataDependency(projections[i + 1], diff_fit, 8e6);
+        this->addDataDependency(diff_fit, concat_fit, 1e3);
+    }
+
+    auto imgtbl = this->addTask("mImgtbl", 2e10, 70);
+    for (unsigned long i = 0; i < width; i++) {
+        auto background = this->addTask("mBackground", 2e10, 65);
+        this->addDataDependency(projections[i], background, 8e6);
+        this->addDataDependency(bg_model, background, 1e4);
+        this->addDataDependency(background, imgtbl, 8e6);
+    }
+
+    auto add = this->addTask("mAdd", 5e11, 90);
+    auto shrink = this->addTask("mShrink", 5e10, 85);
+    auto jpeg = this->addTask("mJPEG", 2e10, 80);
+    this->addDataDependency(imgtbl, add, 1e5);
+    this->addDataDependency(add, shrink, 1e9);
+    this->addDataDependency(shrink, jpeg, 1e8);
+}
+
+/**
+ * @brief An Epigenomics-like sequencing workflow: a split task, independent chains of four filtering
+ *        and mapping tasks, and a merge/index/pileup tail
+ */
+void WorkflowGenerator::generateEpigenomics() {
+    unsigned long num_chains = (this->num_tasks - 4) / 4;
+
+    auto split = this->addTask("fastqSplit", 5e10, 95);
+    split->addInputFile(this->workflow->addFile("sequence_input", 1e9));
+    auto merge = this->addTask("mapMerge", 1e11, 90);
+
+    for (unsigned long i = 0; i < num_chains; i++) {
+        auto filter = this->addTask("filterContams", 2e10, 75);
+        auto sol2sanger = this->addTask("sol2sanger", 1e10, 60);
+        auto fast2bfq = this->addTask("fast2bfq", 1e10, 70);
+        auto map = this->addTask("map", 5e11, 99);
+        this->addDataDependency(split, filter, 1e7);
+        this->addDataDependency(filter, sol2sanger, 1e7);
+        this->addDataDependency(sol2sanger, fast2bfq, 1e7);
+        this->addDataDependency(fast2bfq, map, 5e6);
+        this->addDataDependency(map, merge, 2e6);
+    }
+
+    auto index = this->addTask("maqIndex", 2e11, 95);
+    auto pileup = this->addTask("pileup", 2e11, 95);
+    this->addDataDependency(merge, index, 1e8);
+    this->addDataDependency(index, pileup, 1e8);
+}
@@ -0,0 +1,50 @@
+/**
+ * Copyright (c) 2020-2021. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef ENERGY_AWARE_WORKFLOWGENERATOR_H
+#define ENERGY_AWARE_WORKFLOWGENERATOR_H
+
+#include <random>
+#include <wrench-dev.h>
+
+/**
+ * @brief A generator of synthetic workflows with parameterized DAG shapes, described by
+ *        specifications of the form "synthetic:<shape>:<number of tasks>[:<seed>]"
+ */
+class WorkflowGenerator {
+public:
+    /** @brief Supported DAG shapes */
+    static const std::vector<std::string> SHAPES;
+
+    static bool isSyntheticWorkflow(const std::string &specification);
+
+    static std::string getSpecification(const std::string &shape, unsigned long num_tasks, unsigned long seed = 0);
+
+    explicit WorkflowGenerator(const std::string &specification);
+
+    wrench::Workflow *generate();
+
+private:
+    wrench::WorkflowTask *addTask(const std::string &name, double mean_flops, double mean_cpu);
+
+    void addDataDependency(wrench::WorkflowTask *parent, wrench::WorkflowTask *child, double mean_size);
+
+    void generateForkJoin();
+
+    void generateMontage();
+
+    void generateEpigenomics();
+
+    std::string shape;
+    unsigned long num_tasks;
+    std::mt19937_64 random_engine;
+    wrench::Workflow *workflow;
+};
+
+#endif //ENERGY_AWARE_WORKFLOWGENERATOR_H
@@ -0,0 +1,255 @@
+/**
+ * Copyright (c) 2020-2021. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "WorkflowSnapshot.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Snapshot layout (native byte order):
+ *   magic "EAWFSNP1"
+ *   uint64 number of files, then per file: uint32 ID length, ID bytes, double size
+ *   uint64 number of tasks, then per task: uint32 ID length, ID bytes, double flops, uint64 min cores,
+ *          uint64 max cores, double memory, double average CPU, uint64 bytes read, uint64 bytes written,
+ *          uint32 number of input files, uint32 number of output files, then the input and output
+ *          file indices (uint32)
+ *   uint64 number of dependencies, then per dependency: uint32 parent task index, uint32 child task index
+ */
+const char WorkflowSnapshot::MAGIC[8] = {'E', 'A', 'W', 'F', 'S', 'N', 'P', '1'};
+
+/**
+ * @brief A cursor over a memory-mapped snapshot
+ */
+class SnapshotReader {
+public:
+    SnapshotReader(const char *data, std::size_t size) : data(data), size(size), offset(0) {}
+
+    template<class T>
+    T read() {
+        T value;
+        this->checkAvailable(sizeof(T));
+        std::memcpy(&value, this->data + this->offset, sizeof(T));
+        this->offset += sizeof(T);
+        return value;
+    }
+
+    std::string readString() {
+        auto length = this->read<uint32_t>();
+        this->checkAvailable(length);
+        std::string value(this->data + this->offset, length);
+        this->offset += length;
+        return value;
+    }
+
+private:
+    void checkAvailable(std::size_t length) const {
+        if (this->offset + length > this->size) {
+            throw std::runtime_error("WorkflowSnapshot::load(): truncated snapshot");
+        }
+    }
+
+    const char *data;
+    std::size_t size;
+    std::size_t offset;
+};
+
+/**
+ * @brief Write a workflow snapshot
+ *
+ * @param workflow: the workflow
+ * @param file_path: path to the snapshot file
+ *
+ * @throw std::runtime_error
+ */
+void WorkflowSnapshot::write(wrench::Workflow *workflow, const std::string &file_path) {
+    std::ofstream output(file_path, std::ios::binary | std::ios::trunc);
+    if (!output) {
+        throw std::runtime_error("WorkflowSnapshot::write(): cannot open " + file_path);
+    }
+
+    auto write_value = [&output](auto value) {
+        output.write((const char *) &value, sizeof(value));
+    };
+    auto write_string = [&output, &write_value](const std::string &value) {
+        write_value((uint32_t) value.size());
+        output.write(value.data(), value.size());
+    };
+
+    auto tasks = workflow->getTasks();
+
+    // index files and tasks
+    std::vector<wrench::WorkflowFile *> files;
+    std::unordered_map<wrench::WorkflowFile *, uint32_t> file_indices;
+    std::unordered_map<wrench::WorkflowTask *, uint32_t> task_indices;
+    for (std::size_t t = 0; t < tasks.size(); t++) {
+        auto task = tasks[t];
+        task_indices[task] = (uint32_t) t;
+        for (auto const &task_files : {task->getInputFiles(), task->getOutputFiles()}) {
+            for (auto file : task_files) {
+                if (file_indices.find(file) == file_indices.end()) {
+                    file_indices[file] = files.size();
+                    files.push_back(file);
+                }
+            }
+        }
+    }
+
+    output.write(MAGIC, sizeof(MAGIC));
+
+    write_value((uint64_t) files.size());
+    for (auto file : files) {
+        write_string(file->getID());
+        write_value((double) file->getSize());
+    }
+
+    write_value((uint64_t) tasks.size());
+    for (auto task : tasks) {
+        write_string(task->getID());
+        write_value((double) task->getFlops());
+        write_value((uint64_t) task->getMinNumCores());
+        write_value((uint64_t) task->getMaxNumCores());
+        write_value((double) task->getMemoryRequirement());
+        write_value((double) task->getAverageCPU());
+        write_value((uint64_t) task->getBytesRead());
+        write_value((uint64_t) task->getBytesWritten());
+
+        auto input_files = task->getInputFiles();
+        auto output_files = task->getOutputFiles();
+        write_value((uint32_t) input_files.size());
+        write_value((uint32_t) output_files.size());
+        for (auto const &task_files : {input_files, output_files}) {
+            for (auto file : task_files) {
+                write_value(file_indices.at(file));
+            }
+        }
+    }
+
+    std::vector<std::pair<uint32_t, uint32_t>> dependencies;
+    for (auto task : tasks) {
+        for (auto parent : workflow->getTaskParents(task)) {
+            dependencies.emplace_back(task_indices.at(parent), task_indices.at(task));
+        }
+    }
+    write_value((uint64_t) dependencies.size());
+    for (auto &dependency : dependencies) {
+        write_value(dependency.first);
+        write_value(dependency.second);
+    }
+
+    if (!output) {
+        throw std::runtime_error("WorkflowSnapshot::write(): error while writing " + file_path);
+    }
+}
+
+/**
+ * @brief Load a workflow from a memory-mapped snapshot
+ *
+ * @param file_path: path to the snapshot file
+ *
+ * @return the workflow
+ *
+ * @throw std::runtime_error
+ */
+wrench::Workflow *WorkflowSnapshot::load(const std::string &file_path) {
+    int fd = open(file_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("WorkflowSnapshot::load(): cannot open " + file_path);
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size < (off_t) sizeof(MAGIC)) {
+        close(fd);
+        throw std::runtime_error("WorkflowSnapshot::load(): invalid snapshot " + file_path);
+    }
+    std::size_t size = file_stat.st_size;
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("WorkflowSnapshot::load(): cannot map " + file_path);
+    }
+
+    auto workflow = new wrench::Workflow();
+    try {
+        SnapshotReader reader((const char *) mapping, size);
+        for (char c : MAGIC) {
+            if (reader.read<char>() != c) {
+                throw std::runtime_error("WorkflowSnapshot::load(): " + file_path + " is not a workflow snapshot");
+            }
+        }
+
+        auto num_files = reader.read<uint64_t>();
+        std::vector<wrench::WorkflowFile *> files(num_files);
+        for (auto &file : files) {
+            auto id = reader.readString();
+            file = workflow->addFile(id, reader.read<double>());
+        }
+
+        auto num_tasks = reader.read<uint64_t>();
+        std::vector<wrench::WorkflowTask *> tasks(num_tasks);
+        std::vector<std::vector<uint32_t>> input_files(num_tasks);
+        for (std::size_t i = 0; i < num_tasks; i++) {
+            auto id = reader.readString();
+            auto flops = reader.read<double>();
+            auto min_num_cores = reader.read<uint64_t>();
+            auto max_num_cores = reader.read<uint64_t>();
+            auto memory = reader.read<double>();
+            tasks[i] = workflow->addTask(id, flops, min_num_cores, max_num_cores, memory);
+            tasks[i]->setAverageCPU(reader.read<double>());
+            tasks[i]->setBytesRead(reader.read<uint64_t>());
+            tasks[i]->setBytesWritten(reader.read<uint64_t>());
+
+            auto num_input_files = reader.read<uint32_t>();
+            auto num_output_files = reader.read<uint32_t>();
+            for (uint32_t f = 0; f < num_input_files; f++) {
+                input_files[i].push_back(reader.read<uint32_t>());
+            }
+            for (uint32_t f = 0; f < num_output_files; f++) {
+                tasks[i]->addOutputFile(files.at(reader.read<uint32_t>()));
+            }
+        }
+
+        // input files are added once all output files are known, as they imply data dependencies
+        for (std::size_t i = 0; i < num_tasks; i++) {
+            for (auto file_index : input_files[i]) {
+                tasks[i]->addInputFile(files.at(file_index));
+            }
+        }
+
+        auto num_dependencies = reader.read<uint64_t>();
+        for (std::size_t d = 0; d < num_dependencies; d++) {
+            auto parent = reader.read<uint32_t>();
+            auto child = reader.read<uint32_t>();
+            workflow->addControlDependency(tasks.at(parent), tasks.at(child));
+        }
+    } catch (...) {
+        munmap(mapping, size);
+        delete workflow;
+        throw;
+    }
+
+    munmap(mapping, size);
+    return workflow;
+}
+
+/**
+ * @brief Check whether a file is a workflow snapshot
+ *
+ * @param file_path: path to the file
+ *
+ * @return true if the file starts with the snapshot magic
+ */
+bool WorkflowSnapshot::isSnapshot(const std::string &file_path) {
+    std::ifstream input(file_path, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    return input.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
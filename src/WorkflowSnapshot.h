@@ -0,0 +1,31 @@
+/**
+ * Copyright (c) 2020-2021. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef ENERGY_AWARE_WORKFLOWSNAPSHOT_H
+#define ENERGY_AWARE_WORKFLOWSNAPSHOT_H
+
+#include <wrench-dev.h>
+
+/**
+ * @brief A compact binary snapshot of a parsed workflow (tasks, flops, average CPU, files and
+ *        dependencies), which can be loaded much faster than the original JSON file
+ */
+class WorkflowSnapshot {
+public:
+    static void write(wrench::Workflow *workflow, const std::string &file_path);
+
+    static wrench::Workflow *load(const std::string &file_path);
+
+    static bool isSnapshot(const std::string &file_path);
+
+private:
+    static const char MAGIC[8];
+};
+
+#endif //ENERGY_AWARE_WORKFLOWSNAPSHOT_H
@@ -0,0 +1,84 @@
+/**
+ * Copyright (c) 2020-2021. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "ClusterState.h"
+
+#include <wrench-dev.h>
+
+/**
+ * @brief Notify that a VM has started
+ *
+ * @param vm_name: the VM name
+ * @param vm_pm: the name of the physical host of the VM
+ * @param num_cores: the number of cores of the VM
+ */
+void ClusterState::notifyVMStart(const std::string &vm_name, const std::string &vm_pm, unsigned long num_cores) {
+    this->running_vms.insert(vm_name);
+    this->updateWorkerRunningCores(vm_pm, (int) num_cores);
+}
+
+/**
+ * @brief Notify that a VM has been shut down
+ *
+ * @param vm_name: the VM name
+ * @param vm_pm: the name of the physical host of the VM
+ * @param num_cores: the number of cores of the VM
+ */
+void ClusterState::notifyVMShutdown(const std::string &vm_name, const std::string &vm_pm, unsigned long num_cores) {
+    this->running_vms.erase(vm_name);
+    this->updateWorkerRunningCores(vm_pm, -(int) num_cores);
+}
+
+/**
+ * @brief Whether a VM is running
+ *
+ * @param vm_name: the VM name
+ *
+ * @return true if the VM has been started and not shut down since
+ */
+bool ClusterState::isVMRunning(const std::string &vm_name) const {
+    return this->running_vms.count(vm_name) > 0;
+}
+
+/**
+ * @brief Get the number of cores of the running VMs of every host that ever ran a VM
+ *
+ * @return the number of cores, per host
+ */
+const std::map<std::string, int> &ClusterState::getWorkerRunningCores() const {
+    return this->worker_running_cores;
+}
+
+/**
+ * @brief Whether a host runs VMs but still has cores that are not allocated to a VM
+ *
+ * @return true if there is such a host
+ */
+bool ClusterState::hasPartiallyUsedHost() const {
+    return this->num_partially_used_hosts > 0;
+}
+
+/**
+ * @brief Update the number of cores of the running VMs of a host, and the number of partially used hosts
+ *
+ * @param hostname: the host name
+ * @param num_cores: the number of cores of the VMs that started (positive) or stopped (negative)
+ */
+void ClusterState::updateWorkerRunningCores(const std::string &hostname, int num_cores) {
+    int host_num_cores = (int) wrench::Simulation::getHostNumCores(hostname);
+    auto &running_cores = this->worker_running_cores[hostname];
+    bool was_partially_used = running_cores > 0 && running_cores < host_num_cores;
+    running_cores += num_cores;
+    bool is_partially_used = running_cores > 0 && running_cores < host_num_cores;
+    if (is_partially_used && !was_partially_used) {
+        this->num_partially_used_hosts++;
+    } else if (was_partially_used && !is_partially_used) {
+        this->num_partially_used_hosts--;
+    }
+}
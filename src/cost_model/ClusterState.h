@@ -0,0 +1,43 @@
+/**
+ * Copyright (c) 2020-2021. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef ENERGY_AWARE_CLUSTERSTATE_H
+#define ENERGY_AWARE_CLUSTERSTATE_H
+
+#include <map>
+#include <string>
+#include <unordered_set>
+
+/**
+ * @brief The state of the VMs and hosts of a cloud service that cost models evaluate placements against,
+ *        maintained by the scheduling algorithm as VMs start and stop
+ */
+class ClusterState {
+public:
+    void notifyVMStart(const std::string &vm_name, const std::string &vm_pm, unsigned long num_cores);
+
+    void notifyVMShutdown(const std::string &vm_name, const std::string &vm_pm, unsigned long num_cores);
+
+    bool isVMRunning(const std::string &vm_name) const;
+
+    const std::map<std::string, int> &getWorkerRunningCores() const;
+
+    bool hasPartiallyUsedHost() const;
+
+private:
+    void updateWorkerRunningCores(const std::string &hostname, int num_cores);
+
+    std::unordered_set<std::string> running_vms;
+    /** @brief Number of cores of the running VMs of each host */
+    std::map<std::string, int> worker_running_cores;
+    /** @brief Number of hosts that run VMs but still have cores that are not allocated to a VM */
+    unsigned long num_partially_used_hosts = 0;
+};
+
+#endif //ENERGY_AWARE_CLUSTERSTATE_H
@@ -0,0 +1,28 @@
+/**
+ * Copyright (c) 2020-2021. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "CostModel.h"
+
+/**
+ * @brief Estimate the cost of running a task on each candidate VM
+ *
+ * @param task: the task
+ * @param vm_names: the candidate VMs
+ * @param cluster_state: the state of the VMs and hosts of the cloud service
+ * @param costs: the costs, one per candidate VM (reused across calls to avoid allocations)
+ */
+void CostModel::estimateCosts(const wrench::WorkflowTask *task,
+                              const std::vector<std::string> &vm_names,
+                              const ClusterState &cluster_state,
+                              std::vector<double> &costs) {
+    costs.resize(vm_names.size());
+    for (std::size_t i = 0; i < vm_names.size(); i++) {
+        costs[i] = this->estimateCost(task, vm_names[i], cluster_state);
+    }
+}
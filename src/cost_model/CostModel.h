@@ -12,6 +12,8 @@
 
 #include <wrench-dev.h>
 
+#include "ClusterState.h"
+
 class CostModel {
 public:
     /**
@@ -22,8 +24,13 @@ public:
     virtual ~CostModel() = default;
 
     virtual double estimateCost(const wrench::WorkflowTask *task,
-                                std::string vm_name,
-                                std::map<std::string, int> worker_vms) = 0;
+                                const std::string &vm_name,
+                                const ClusterState &cluster_state) = 0;
+
+    virtual void estimateCosts(const wrench::WorkflowTask *task,
+                               const std::vector<std::string> &vm_names,
+                               const ClusterState &cluster_state,
+                               std::vector<double> &costs);
 
 protected:
     std::shared_ptr<wrench::CloudComputeService> cloud_service;
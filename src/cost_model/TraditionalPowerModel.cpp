@@ -22,23 +22,10 @@ TraditionalPowerModel::TraditionalPowerModel(shared_ptr<wrench::CloudComputeServ
  * @param vm_name
  * @return
  */
-double TraditionalPowerModel::estimateCost(const wrench::WorkflowTask *task, std::string vm_name,
-                                           std::map<std::string, int> worker_vms) {
-    if (this->cloud_service->isVMRunning(vm_name)) {
+double TraditionalPowerModel::estimateCost(const wrench::WorkflowTask *task, const std::string &vm_name,
+                                           const ClusterState &cluster_state) {
+    if (cluster_state.isVMRunning(vm_name)) {
         return 0;
     }
-
-    bool has_idle_cores = false;
-    for (const auto &host : this->cloud_service->getExecutionHosts()) {
-        if (worker_vms.find(host) == worker_vms.end()) {
-            continue;
-        }
-        int running_vms = worker_vms.at(host);
-        if (running_vms > 0 && running_vms < wrench::Simulation::getHostNumCores(host)) {
-            has_idle_cores = true;
-            break;
-        }
-    }
-
-    return has_idle_cores ? 1 : 2;
+    return cluster_state.hasPartiallyUsedHost() ? 1 : 2;
 }
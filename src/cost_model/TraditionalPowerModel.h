@@ -17,8 +17,8 @@ public:
     explicit TraditionalPowerModel(std::shared_ptr<wrench::CloudComputeService> &cloud_service);
 
     double estimateCost(const wrench::WorkflowTask *task,
-                        std::string vm_name,
-                        std::map<std::string, int> worker_vms) override;
+                        const std::string &vm_name,
+                        const ClusterState &cluster_state) override;
 };
 
 #endif //ENERGY_AWARE_TRADITIONALPOWERMODEL_H
@@ -32,66 +32,34 @@ std::string EnRealAlgorithm::scheduleTask(const wrench::WorkflowTask *task) {
 //        wrench::Simulation::turnOnHost(host);
 //    }
 
-    // find candidate vms
-    std::vector<std::string> candidate_vms;
-    for (auto &it : this->vm_worker_map) {
-        candidate_vms.push_back(it.first);
+    // look for a running, idle VM (shut down VMs are forgotten, hence never restarted)
+    if (!this->available_vms.empty()) {
+        return *this->available_vms.begin();
     }
 
-    // look for a running, idle VM
-    std::string vm_name;
-    for (const auto &vm : candidate_vms) {
-        if (this->cloud_service->isVMRunning(vm) &&
-            this->cloud_service->getVMComputeService(vm)->getTotalNumIdleCores() > 0) {
-            return vm;
-
-        } else if (vm_name.empty() && this->cloud_service->isVMDown(vm)) {
-            vm_name = vm;
-        }
+    // create VM, as no viable VM could be found
+    if (this->getTotalNumFreeCores() == 0) {
+        return "";
     }
-
-    if (vm_name.empty()) {
-        // create VM, as no viable VM could be found
-        if (this->cloud_service->getTotalNumIdleCores() == 0) {
-            return "";
-        }
-        bool turned_on = false;
-        for (auto &host : this->cloud_service->getExecutionHosts()) {
-            if (!wrench::Simulation::isHostOn(host)) {
-                wrench::Simulation::turnOnHost(host);
-                turned_on = true;
-                break;
-            }
-        }
-        if (turned_on) {
-            vm_name = this->cloud_service->createVM(1, 1000000000);
-        }
+    auto host = this->getOffHost();
+    if (host.empty()) {
+        return "";
     }
-
+    this->turnOnHost(host);
+    auto vm_name = this->createVM();
     if (vm_name.empty()) {
         return "";
     }
 
     // start VM
-    this->cloud_service->startVM(vm_name);
-    auto vm_pm = this->cloud_service->getVMPhysicalHostname(vm_name);
-
-    if (this->vm_worker_map.find(vm_name) == this->vm_worker_map.end()) {
-        this->vm_worker_map.insert(std::pair<std::string, std::string>(vm_name, vm_pm));
-
-        if (this->worker_running_vms.find(vm_pm) == this->worker_running_vms.end()) {
-            this->worker_running_vms.insert(std::pair<std::string, int>(vm_pm, 0));
-        }
-    }
-    this->worker_running_vms.at(vm_pm)++;
+    this->vm_worker_map.insert(std::pair<std::string, std::string>(vm_name, this->startVM(vm_name)));
 
     return vm_name;
 }
 
 void EnRealAlgorithm::notifyVMShutdown(const std::string &vm_name, const std::string &vm_pm) {
     this->vm_worker_map.erase(vm_name);
-    this->worker_running_vms.at(vm_pm)--;
-    if (this->worker_running_vms.at(vm_pm) == 0) {
-        wrench::Simulation::turnOffHost(vm_pm);
-    }
+    this->releaseVM(vm_name, vm_pm);
+    this->down_vms.erase(vm_name);
+    this->down_vms_per_host[vm_pm].erase(vm_name);
 }
@@ -8,6 +8,7 @@
  */
 
 #include "IOAwareAlgorithm.h"
+#include "Profiler.h"
 
 WRENCH_LOG_CATEGORY(ioaware_algorithm, "Log category for IOAwareAlgorithm");
 
@@ -27,59 +28,92 @@ IOAwareAlgorithm::IOAwareAlgorithm(std::shared_ptr<wrench::CloudComputeService>
  * @return
  */
 std::vector<wrench::WorkflowTask *> IOAwareAlgorithm::sortTasks(const vector<wrench::WorkflowTask *> &tasks) {
-    auto sorted_tasks = tasks;
-
-    std::sort(sorted_tasks.begin(), sorted_tasks.end(),
-              [](const wrench::WorkflowTask *t1, const wrench::WorkflowTask *t2) -> bool {
-                  if (t1->getAverageCPU() == t2->getAverageCPU()) {
-                      return ((uintptr_t) t1 < (uintptr_t) t2);
-                  } else {
-                      return (t1->getAverageCPU() > t2->getAverageCPU());
-                  }
-              });
+    // by decreasing average CPU usage
+    auto sorted_tasks = this->prioritizeTasks(tasks);
 
     // plan tasks depending on cpu usage
     this->task_to_host_schedule.clear();
-    auto num_cores_host = this->cloud_service->getPerHostNumCores();
-    auto idle_cores_host = this->cloud_service->getPerHostNumIdleCores();
-    std::vector<std::string> scheduled_vms;
+    std::map<std::string, unsigned long> idle_cores_host;
+    {
+        Profiler::Pause profiler_pause;
+        idle_cores_host = this->cloud_service->getPerHostNumIdleCores();
+    }
+
+    // hosts ordered by number of idle cores, then by name, so that the least idle host is found in O(log n)
+    std::set<std::pair<unsigned long, std::string>> hosts_by_idle_cores;
+    for (auto &it : idle_cores_host) {
+        hosts_by_idle_cores.insert(std::make_pair(it.second, it.first));
+    }
+
+    // existing VMs are reused in name order, each one at most once per round, so a single cursor suffices
+    auto vm_it = this->vm_worker_map.begin();
 
     for (auto task : sorted_tasks) {
         std::string candidate_host;
 
-        // look for existing VMs
-        for (auto &it : this->vm_worker_map) {
-            if ((this->cloud_service->isVMRunning(it.first) &&
-                 this->cloud_service->getVMComputeService(it.first)->getTotalNumIdleCores() > 0) ||
-                this->cloud_service->isVMDown(it.first)) {
-                if (!std::count(scheduled_vms.begin(), scheduled_vms.end(), it.first)) {
-                    scheduled_vms.push_back(it.first);
-                    candidate_host = it.second;
-                    break;
-                }
+        // look for existing VMs (the state of the VMs is queried from the cloud service, which already knows
+        // about the jobs that completed at this date but whose completion events are still pending)
+        for (; vm_it != this->vm_worker_map.end(); ++vm_it) {
+            bool reusable;
+            {
+                Profiler::Pause profiler_pause;
+                reusable = (this->cloud_service->isVMRunning(vm_it->first) &&
+                            this->cloud_service->getVMComputeService(vm_it->first)->getTotalNumIdleCores() > 0) ||
+                           this->cloud_service->isVMDown(vm_it->first);
+            }
+            if (reusable) {
+                candidate_host = vm_it->second;
+                ++vm_it;
+                break;
             }
         }
 
         if (candidate_host.empty()) {
-            unsigned long candidate_host_idle_cores = LONG_MAX;
-            // find candidate host
-            for (auto &it : idle_cores_host) {
-                if (it.second > 0 && it.second < candidate_host_idle_cores) {
-                    candidate_host = it.first;
-                    candidate_host_idle_cores = it.second;
-                }
+            // find candidate host, i.e., the least idle host that still has idle cores
+            auto host_it = hosts_by_idle_cores.lower_bound(std::make_pair(1ul, std::string()));
+            if (host_it != hosts_by_idle_cores.end()) {
+                candidate_host = host_it->second;
             }
         }
         if (candidate_host.empty()) {
             break;
         }
-        idle_cores_host[candidate_host]--;
+        // a host without idle cores (whose VM is reused) stays out of the candidate hosts
+        auto &idle_cores = idle_cores_host[candidate_host];
+        if (idle_cores > 0) {
+            hosts_by_idle_cores.erase(std::make_pair(idle_cores, candidate_host));
+            idle_cores--;
+            hosts_by_idle_cores.insert(std::make_pair(idle_cores, candidate_host));
+        }
 
         this->task_to_host_schedule.insert(std::pair<wrench::WorkflowTask *, std::string>(task, candidate_host));
     }
     return sorted_tasks;
 }
 
+/**
+ * @brief Get the priority of a ready task (tasks with higher priorities are scheduled first)
+ *
+ * @param task: the task
+ *
+ * @return the average CPU usage of the task
+ */
+double IOAwareAlgorithm::getTaskPriority(const wrench::WorkflowTask *task) const {
+    return task->getAverageCPU();
+}
+
+/**
+ * @brief Get the host on which the last call to sortTasks() planned to run a task
+ *
+ * @param task: the task
+ *
+ * @return the host name, or an empty string if the task could not be planned
+ */
+std::string IOAwareAlgorithm::getPlannedHost(const wrench::WorkflowTask *task) const {
+    auto it = this->task_to_host_schedule.find(task);
+    return it == this->task_to_host_schedule.end() ? "" : it->second;
+}
+
 /**
  *
  * @param task
@@ -93,49 +127,36 @@ std::string IOAwareAlgorithm::scheduleTask(const wrench::WorkflowTask *task) {
 
     auto host = this->task_to_host_schedule.at(task);
     if (!wrench::Simulation::isHostOn(host)) {
-        wrench::Simulation::turnOnHost(host);
+        this->turnOnHost(host);
     }
 
-    // find candidate vms
-    std::vector<std::string> candidate_vms;
-    for (auto &it : this->vm_worker_map) {
-        if (it.second == host) {
-            candidate_vms.push_back(it.first);
-        }
+    // look for a running, idle VM on the host, or else a VM of the host that is down
+    auto available_vms_it = this->available_vms_per_host.find(host);
+    if (available_vms_it != this->available_vms_per_host.end() && !available_vms_it->second.empty()) {
+        return *available_vms_it->second.begin();
     }
-
-    // look for a running, idle VM
     std::string vm_name;
-    for (const auto &vm : candidate_vms) {
-        if (this->cloud_service->isVMRunning(vm) &&
-            this->cloud_service->getVMComputeService(vm)->getTotalNumIdleCores() > 0) {
-            return vm;
-
-        } else if (vm_name.empty() && this->cloud_service->isVMDown(vm)) {
-            vm_name = vm;
-        }
+    auto down_vms_it = this->down_vms_per_host.find(host);
+    if (down_vms_it != this->down_vms_per_host.end() && !down_vms_it->second.empty()) {
+        vm_name = *down_vms_it->second.begin();
     }
 
     if (vm_name.empty()) {
         // create VM, as no viable VM could be found
-        if (this->cloud_service->getPerHostNumIdleCores().at(host) == 0) {
+        if (this->getHostNumFreeCores(host) == 0) {
+            return "";
+        }
+        vm_name = this->createVM();
+        if (vm_name.empty()) {
             return "";
         }
-        vm_name = this->cloud_service->createVM(1, 1000000000);
     }
 
     // start VM
-    this->cloud_service->startVM(vm_name);
-    auto vm_pm = this->cloud_service->getVMPhysicalHostname(vm_name);
-
+    auto vm_pm = this->startVM(vm_name);
     if (this->vm_worker_map.find(vm_name) == this->vm_worker_map.end()) {
         this->vm_worker_map.insert(std::pair<std::string, std::string>(vm_name, vm_pm));
-
-        if (this->worker_running_vms.find(vm_pm) == this->worker_running_vms.end()) {
-            this->worker_running_vms.insert(std::pair<std::string, int>(vm_pm, 0));
-        }
     }
-    this->worker_running_vms.at(vm_pm)++;
 
     return vm_name;
 }
@@ -146,8 +167,5 @@ std::string IOAwareAlgorithm::scheduleTask(const wrench::WorkflowTask *task) {
  * @param vm_pm
  */
 void IOAwareAlgorithm::notifyVMShutdown(const string &vm_name, const string &vm_pm) {
-    this->worker_running_vms.at(vm_pm)--;
-    if (this->worker_running_vms.at(vm_pm) == 0) {
-        wrench::Simulation::turnOffHost(vm_pm);
-    }
+    this->releaseVM(vm_name, vm_pm);
 }
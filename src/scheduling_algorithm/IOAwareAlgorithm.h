@@ -21,9 +21,13 @@ public:
 
     std::string scheduleTask(const wrench::WorkflowTask *task) override;
 
+    std::string getPlannedHost(const wrench::WorkflowTask *task) const override;
+
     void notifyVMShutdown(const std::string &vm_name, const std::string &vm_pm) override;
 
 protected:
+    double getTaskPriority(const wrench::WorkflowTask *task) const override;
+
     std::map<const wrench::WorkflowTask *, std::string> task_to_host_schedule;
 };
 
@@ -8,6 +8,9 @@
  */
 
 #include "IOAwareBalanceAlgorithm.h"
+#include "Profiler.h"
+
+#include <algorithm>
 
 WRENCH_LOG_CATEGORY(ioaware_balance_algorithm, "Log category for IOAwareBalanceAlgorithm");
 
@@ -27,49 +30,64 @@ IOAwareBalanceAlgorithm::IOAwareBalanceAlgorithm(std::shared_ptr<wrench::CloudCo
  * @return
  */
 std::vector<wrench::WorkflowTask *> IOAwareBalanceAlgorithm::sortTasks(const vector<wrench::WorkflowTask *> &tasks) {
-    auto sorted_tasks = tasks;
-
-    std::sort(sorted_tasks.begin(), sorted_tasks.end(),
-              [](const wrench::WorkflowTask *t1, const wrench::WorkflowTask *t2) -> bool {
-                  if (t1->getAverageCPU() == t2->getAverageCPU()) {
-                      return ((uintptr_t) t1 < (uintptr_t) t2);
-                  } else {
-                      return (t1->getAverageCPU() > t2->getAverageCPU());
-                  }
-              });
+    // by decreasing average CPU usage
+    auto sorted_tasks = this->prioritizeTasks(tasks);
 
     // plan tasks depending on cpu usage
-    auto num_cores_host = this->cloud_service->getPerHostNumCores();
-    auto idle_cores_host = this->cloud_service->getPerHostNumIdleCores();
-    std::vector<std::string> scheduled_vms;
-
-    // balance tasks among hosts
-    unsigned long max_num_full_hosts = std::floor((sorted_tasks.size() > 48 ? 48 : sorted_tasks.size()) / 12);
-    unsigned long max_tasks_in_unfilled_host = (sorted_tasks.size() > 48 ? 48 : sorted_tasks.size()) % 12;
-    auto hosts_list = this->cloud_service->getExecutionHosts();
-    vector<wrench::WorkflowTask *> new_sort(sorted_tasks.size() > 48 ? 48 : sorted_tasks.size());
+    this->task_to_host_schedule.clear();
+    std::map<std::string, unsigned long> num_cores_host;
+    std::map<std::string, unsigned long> idle_cores_host;
+    std::vector<std::string> hosts_list;
+    {
+        Profiler::Pause profiler_pause;
+        num_cores_host = this->cloud_service->getPerHostNumCores();
+        idle_cores_host = this->cloud_service->getPerHostNumIdleCores();
+        hosts_list = this->cloud_service->getExecutionHosts();
+    }
 
-    int host_index = 0;
-    int core_index = 0;
+    // consolidate tasks on as few hosts as possible, filling the hosts that are already in use first; the
+    // capacity of a host counts its cores that are not allocated to a VM and the idle cores of its running VMs,
+    // which scheduleTask() reuses
+    std::vector<std::string> selected_hosts;
+    std::vector<unsigned long> host_capacity;
+    unsigned long total_capacity = 0;
+    for (int pass = 0; pass < 2 && total_capacity < sorted_tasks.size(); pass++) {
+        for (auto &host : hosts_list) {
+            if (total_capacity >= sorted_tasks.size()) {
+                break;
+            }
+            auto idle_cores = idle_cores_host[host];
+            auto capacity = idle_cores + this->getHostNumIdleVMCores(host);
+            bool partially_used = idle_cores < num_cores_host[host];
+            if (capacity > 0 && partially_used == (pass == 0)) {
+                selected_hosts.push_back(host);
+                host_capacity.push_back(capacity);
+                total_capacity += capacity;
+            }
+        }
+    }
 
-    for (std::size_t i = 0; i != new_sort.size(); ++i) {
-        auto task = sorted_tasks[i];
+    // balance tasks among the selected hosts, so that the most CPU-intensive tasks are spread across hosts
+    std::size_t num_planned_tasks = std::min<std::size_t>(sorted_tasks.size(), total_capacity);
+    std::vector<std::vector<wrench::WorkflowTask *>> host_tasks(selected_hosts.size());
+    std::size_t host_index = 0;
 
-        if ((host_index == max_num_full_hosts && core_index >= max_tasks_in_unfilled_host) ||
-            host_index > max_num_full_hosts) {
-            host_index = 0;
+    for (std::size_t i = 0; i < num_planned_tasks; i++) {
+        while (host_tasks[host_index].size() == host_capacity[host_index]) {
+            host_index = (host_index + 1) % selected_hosts.size();
         }
-
-        int idx = core_index + host_index * 12;
-        new_sort[idx] = task;
+        host_tasks[host_index].push_back(sorted_tasks[i]);
         this->task_to_host_schedule.insert(
-                std::pair<wrench::WorkflowTask *, std::string>(task, hosts_list[host_index]));
+                std::pair<wrench::WorkflowTask *, std::string>(sorted_tasks[i], selected_hosts[host_index]));
+        host_index = (host_index + 1) % selected_hosts.size();
+    }
 
-        host_index++;
-        if (host_index == hosts_list.size()) {
-            host_index = 0;
-            core_index++;
-        }
+    // tasks are dispatched host by host; tasks that do not fit are queued until cores become idle
+    std::vector<wrench::WorkflowTask *> new_sort;
+    new_sort.reserve(sorted_tasks.size());
+    for (auto &tasks_on_host : host_tasks) {
+        new_sort.insert(new_sort.end(), tasks_on_host.begin(), tasks_on_host.end());
     }
+    new_sort.insert(new_sort.end(), sorted_tasks.begin() + num_planned_tasks, sorted_tasks.end());
     return new_sort;
 }
@@ -8,6 +8,10 @@
  */
 
 #include "SPSSEBAlgorithm.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <iterator>
 
 WRENCH_LOG_CATEGORY(spss_eb_algorithm, "Log category for SPSSEBAlgorithm");
 
@@ -27,18 +31,8 @@ SPSSEBAlgorithm::SPSSEBAlgorithm(std::shared_ptr<wrench::CloudComputeService> &c
  * @return
  */
 std::vector<wrench::WorkflowTask *> SPSSEBAlgorithm::sortTasks(const std::vector<wrench::WorkflowTask *> &tasks) {
-    auto sorted_tasks = tasks;
-
-    std::sort(sorted_tasks.begin(), sorted_tasks.end(),
-              [](const wrench::WorkflowTask *t1, const wrench::WorkflowTask *t2) -> bool {
-                  if (t1->getFlops() == t2->getFlops()) {
-                      return ((uintptr_t) t1 < (uintptr_t) t2);
-                  } else {
-                      return (t1->getFlops() > t2->getFlops());
-                  }
-              });
-
-    return sorted_tasks;
+    // by decreasing number of flops
+    return this->prioritizeTasks(tasks);
 }
 
 /**
@@ -47,88 +41,54 @@ std::vector<wrench::WorkflowTask *> SPSSEBAlgorithm::sortTasks(const std::vector
  * @return
  */
 std::string SPSSEBAlgorithm::scheduleTask(const wrench::WorkflowTask *task) {
-    std::vector<std::string> candidate_vms;
-
-    // look for existing VMs
-    for (const auto &vm : this->vms_pool) {
-        if (this->cloud_service->isVMRunning(vm) &&
-            this->cloud_service->getVMComputeService(vm)->getTotalNumIdleCores() > 0) {
-            candidate_vms.push_back(vm);
-        } else if (this->cloud_service->isVMDown(vm)) {
-            candidate_vms.push_back(vm);
-        }
-    }
+    // look for existing VMs, i.e., running VMs with an idle core and VMs that are down
+    auto &candidate_vms = this->candidate_vms;
+    candidate_vms.clear();
+    std::merge(this->available_vms.begin(), this->available_vms.end(),
+               this->down_vms.begin(), this->down_vms.end(), std::back_inserter(candidate_vms));
 
     // get VM with minimum cost
+    {
+        Profiler::Scope profiler_scope(Profiler::ESTIMATE_COST);
+        this->cost_model->estimateCosts(task, candidate_vms, this->cluster_state, this->candidate_costs);
+    }
     std::string vm_name;
     double min_cost = numeric_limits<double>::max();
-    for (const auto &vm : candidate_vms) {
-        double cost = this->cost_model->estimateCost(task, vm, this->worker_running_vms);
-        if (cost < min_cost) {
-            min_cost = cost;
-            vm_name = vm;
+    for (std::size_t i = 0; i < candidate_vms.size(); i++) {
+        if (this->candidate_costs[i] < min_cost) {
+            min_cost = this->candidate_costs[i];
+            vm_name = candidate_vms[i];
         }
     }
 
     // if there is no cores available on running hosts, turn on another host
-    bool has_idle_host = false;
-    for (auto &it : this->worker_running_vms) {
-        if (wrench::Simulation::isHostOn(it.first) && it.second < wrench::Simulation::getHostNumCores(it.first)) {
-            has_idle_host = true;
-            break;
-        }
-    }
-    if (!has_idle_host) {
-        for (auto &host : this->cloud_service->getExecutionHosts()) {
-            if (!wrench::Simulation::isHostOn(host)) {
-                wrench::Simulation::turnOnHost(host);
-                break;
-            }
+    if (!this->hasHostWithFreeCores()) {
+        auto host = this->getOffHost();
+        if (!host.empty()) {
+            this->turnOnHost(host);
         }
     }
 
     // if VM is down, start it
-    if (!vm_name.empty() && this->cloud_service->isVMDown(vm_name)) {
-        this->cloud_service->startVM(vm_name);
-        auto vm_pm = this->cloud_service->getVMPhysicalHostname(vm_name);
-
-        if (this->vm_worker_map.find(vm_name) == this->vm_worker_map.end()) {
-            this->vm_worker_map.insert(std::pair<std::string, std::string>(vm_name, vm_pm));
-        } else {
-            this->vm_worker_map.at(vm_name) = vm_pm;
-        }
-
-        if (this->worker_running_vms.find(vm_pm) == this->worker_running_vms.end()) {
-            this->worker_running_vms.insert(std::pair<std::string, int>(vm_pm, 1));
-        } else {
-            this->worker_running_vms.at(vm_pm)++;
-        };
-
+    if (!vm_name.empty() && this->down_vms.count(vm_name)) {
+        this->vm_worker_map[vm_name] = this->startVM(vm_name);
         return vm_name;
     }
 
     // if task cannot start now on a running VM, it will start a new VM if possible
-    if (vm_name.empty() && this->cloud_service->getTotalNumIdleCores() > 0) {
+    if (vm_name.empty() && this->getTotalNumFreeCores() > 0) {
 
-        vm_name = this->cloud_service->createVM(1, 1000000000);
-        this->cloud_service->startVM(vm_name);
-        this->vms_pool.insert(vm_name);
-
-        auto vm_pm = this->cloud_service->getVMPhysicalHostname(vm_name);
-        if (this->worker_running_vms.find(vm_pm) == this->worker_running_vms.end()) {
-            this->worker_running_vms.insert(std::pair<std::string, int>(vm_pm, 0));
+        vm_name = this->createVM();
+        if (vm_name.empty()) {
+            return "";
         }
-
-        this->worker_running_vms.at(vm_pm)++;
-        this->vm_worker_map.insert(std::pair<std::string, std::string>(vm_name, vm_pm));
+        this->vms_pool.insert(vm_name);
+        this->vm_worker_map.insert(std::pair<std::string, std::string>(vm_name, this->startVM(vm_name)));
     }
 
     return vm_name;
 }
 
 void SPSSEBAlgorithm::notifyVMShutdown(const std::string &vm_name, const std::string &vm_pm) {
-    this->worker_running_vms.at(vm_pm)--;
-    if (this->worker_running_vms.at(vm_pm) == 0) {
-        wrench::Simulation::turnOffHost(vm_pm);
-    }
+    this->releaseVM(vm_name, vm_pm);
 }
@@ -26,6 +26,9 @@ public:
 
 private:
     std::set<std::string> vms_pool;
+    /** @brief Candidate VMs of a task and their costs, reused across tasks */
+    std::vector<std::string> candidate_vms;
+    std::vector<double> candidate_costs;
 };
 
 #endif //ENERGY_AWARE_SPSSEBALGORITHM_H
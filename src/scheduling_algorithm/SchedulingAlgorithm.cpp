@@ -0,0 +1,401 @@
+/**
+ * Copyright (c) 2020-2021. The WRENCH Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "SchedulingAlgorithm.h"
+#include "Profiler.h"
+
+#include <algorithm>
+
+/**
+ * @brief Get the cloud service whose VMs the algorithm manages
+ *
+ * @return the cloud service
+ */
+std::shared_ptr<wrench::CloudComputeService> SchedulingAlgorithm::getCloudService() const {
+    return this->cloud_service;
+}
+
+/**
+ * @brief Get the host on which the last call to sortTasks() planned to run a task
+ *
+ * @param task: the task
+ *
+ * @return the host name, or an empty string if the algorithm does not plan hosts
+ */
+std::string SchedulingAlgorithm::getPlannedHost(const wrench::WorkflowTask *task) const {
+    return "";
+}
+
+/**
+ * @brief Set the number of cores of the VMs created by the algorithm
+ *
+ * @param num_cores: number of cores per VM, or 0 to size each VM after the number of tasks that are still
+ *                   pending in the current scheduling round (bounded by the idle cores of a host)
+ */
+void SchedulingAlgorithm::setVMNumCores(unsigned long num_cores) {
+    this->vm_size = num_cores;
+}
+
+/**
+ * @brief Set the number of tasks that are still pending in the current scheduling round, which adaptive
+ *        VM sizing uses to pack concurrent tasks on multi-core VMs
+ *
+ * @param num_tasks: number of pending tasks
+ */
+void SchedulingAlgorithm::setNumPendingTasks(unsigned long num_tasks) {
+    this->num_pending_tasks = num_tasks;
+}
+
+/**
+ * @brief Notify that a task has been scheduled (by this algorithm or by the algorithm of another cloud
+ *        service), so that it leaves the ready queue
+ *
+ * @param task: the task
+ */
+void SchedulingAlgorithm::notifyTaskScheduled(const wrench::WorkflowTask *task) {
+    if (this->queued_tasks.erase(task)) {
+        this->ready_queue.erase(std::make_pair(-this->getTaskPriority(task), task->getID()));
+    }
+}
+
+/**
+ * @brief Get the priority of a ready task (tasks with higher priorities are scheduled first)
+ *
+ * @param task: the task
+ *
+ * @return the number of flops of the task
+ */
+double SchedulingAlgorithm::getTaskPriority(const wrench::WorkflowTask *task) const {
+    return task->getFlops();
+}
+
+/**
+ * @brief Sort ready tasks by decreasing priority, ties being broken by task ID. Tasks are kept in a ready
+ *        queue across scheduling rounds, so that only the newly ready tasks are inserted
+ *
+ * @param tasks: the ready tasks
+ *
+ * @return the sorted tasks
+ */
+std::vector<wrench::WorkflowTask *> SchedulingAlgorithm::prioritizeTasks(
+        const std::vector<wrench::WorkflowTask *> &tasks) {
+    for (auto task : tasks) {
+        if (this->queued_tasks.insert(task).second) {
+            this->ready_queue.emplace(std::make_pair(-this->getTaskPriority(task), task->getID()), task);
+        }
+    }
+
+    std::vector<wrench::WorkflowTask *> sorted_tasks;
+    sorted_tasks.reserve(tasks.size());
+    if (this->ready_queue.size() == tasks.size()) {
+        for (auto &it : this->ready_queue) {
+            sorted_tasks.push_back(it.second);
+        }
+    } else {
+        // the queue also holds tasks that are not offered in this round (e.g., left to another cloud service)
+        std::unordered_set<const wrench::WorkflowTask *> offered_tasks(tasks.begin(), tasks.end());
+        for (auto &it : this->ready_queue) {
+            if (offered_tasks.count(it.second)) {
+                sorted_tasks.push_back(it.second);
+            }
+        }
+    }
+    return sorted_tasks;
+}
+
+/**
+ * @brief Notify that a task has been dispatched to a VM, which occupies one of its cores
+ *
+ * @param vm_name: the VM name
+ */
+void SchedulingAlgorithm::notifyTaskStart(const std::string &vm_name) {
+    if (!this->vm_hosts.count(vm_name)) {
+        return;
+    }
+    this->vm_running_tasks[vm_name]++;
+    this->updateVMIndex(vm_name, this->vm_hosts.at(vm_name));
+}
+
+/**
+ * @brief Notify that a task dispatched to a VM has completed, which frees one of its cores
+ *
+ * @param vm_name: the VM name
+ */
+void SchedulingAlgorithm::notifyTaskCompletion(const std::string &vm_name) {
+    auto it = this->vm_running_tasks.find(vm_name);
+    if (it == this->vm_running_tasks.end() || it->second == 0) {
+        return;
+    }
+    it->second--;
+    this->updateVMIndex(vm_name, this->vm_hosts.at(vm_name));
+}
+
+/**
+ * @brief Get the number of VMs started (after being created or shut down) by the algorithm so far
+ *
+ * @return the number of VM starts
+ */
+unsigned long SchedulingAlgorithm::getNumVMStarts() const {
+    return this->num_vm_starts;
+}
+
+/**
+ * @brief Create a VM, with as many cores as the VM sizing policy requires and as fit on a host
+ *
+ * @return the VM name, or an empty string if no host has idle cores
+ */
+std::string SchedulingAlgorithm::createVM() {
+    this->initializeClusterIndex();
+    if (this->hosts_by_free_cores.empty() || this->hosts_by_free_cores.rbegin()->first == 0) {
+        return "";
+    }
+    unsigned long max_idle_cores = this->hosts_by_free_cores.rbegin()->first;
+
+    unsigned long num_cores = (this->vm_size == 0 ? std::max(1ul, this->num_pending_tasks) : this->vm_size);
+    num_cores = std::min(num_cores, max_idle_cores);
+
+    std::string vm_name;
+    {
+        Profiler::Pause profiler_pause;
+        vm_name = this->cloud_service->createVM(num_cores, 1000000000);
+    }
+    this->vm_num_cores[vm_name] = num_cores;
+    return vm_name;
+}
+
+/**
+ * @brief Start a VM, and account for its cores on the host the cloud service placed it on
+ *
+ * @param vm_name: the VM name
+ *
+ * @return the name of the physical host of the VM
+ */
+std::string SchedulingAlgorithm::startVM(const std::string &vm_name) {
+    this->initializeClusterIndex();
+    std::string vm_pm;
+    {
+        Profiler::Pause profiler_pause;
+        this->cloud_service->startVM(vm_name);
+        vm_pm = this->cloud_service->getVMPhysicalHostname(vm_name);
+    }
+    this->num_vm_starts++;
+    auto num_cores = this->getVMNumCores(vm_name);
+
+    auto previous_pm = this->vm_hosts.find(vm_name);
+    if (previous_pm != this->vm_hosts.end()) {
+        this->down_vms_per_host[previous_pm->second].erase(vm_name);
+    }
+    this->down_vms.erase(vm_name);
+    this->vm_hosts[vm_name] = vm_pm;
+    this->vm_running_tasks[vm_name] = 0;
+
+    this->worker_running_vms[vm_pm]++;
+    this->cluster_state.notifyVMStart(vm_name, vm_pm, num_cores);
+    auto &free_cores = this->host_free_cores[vm_pm];
+    this->hosts_by_free_cores.erase(std::make_pair(free_cores, vm_pm));
+    free_cores -= std::min(free_cores, num_cores);
+    this->total_free_cores -= std::min(this->total_free_cores, num_cores);
+    this->hosts_by_free_cores.insert(std::make_pair(free_cores, vm_pm));
+
+    this->updateVMIndex(vm_name, vm_pm);
+    this->updateHostIndex(vm_pm);
+    return vm_pm;
+}
+
+/**
+ * @brief Account for a VM that has been shut down, and turn its host off if it runs no other VM
+ *
+ * @param vm_name: the VM name
+ * @param vm_pm: the name of the physical host of the VM
+ */
+void SchedulingAlgorithm::releaseVM(const std::string &vm_name, const std::string &vm_pm) {
+    this->initializeClusterIndex();
+    auto num_cores = this->getVMNumCores(vm_name);
+
+    this->available_vms.erase(vm_name);
+    this->available_vms_per_host[vm_pm].erase(vm_name);
+    this->down_vms.insert(vm_name);
+    this->down_vms_per_host[vm_pm].insert(vm_name);
+    this->vm_running_tasks.erase(vm_name);
+
+    this->worker_running_vms.at(vm_pm)--;
+    this->cluster_state.notifyVMShutdown(vm_name, vm_pm, num_cores);
+    auto &free_cores = this->host_free_cores[vm_pm];
+    this->hosts_by_free_cores.erase(std::make_pair(free_cores, vm_pm));
+    free_cores += num_cores;
+    this->total_free_cores += num_cores;
+    this->hosts_by_free_cores.insert(std::make_pair(free_cores, vm_pm));
+
+    if (this->worker_running_vms.at(vm_pm) == 0) {
+        this->turnOffHost(vm_pm);
+    } else {
+        this->updateHostIndex(vm_pm);
+    }
+}
+
+/**
+ * @brief Turn a host on
+ *
+ * @param hostname: the host name
+ */
+void SchedulingAlgorithm::turnOnHost(const std::string &hostname) {
+    this->initializeClusterIndex();
+    wrench::Simulation::turnOnHost(hostname);
+    this->off_hosts.erase(this->host_ids.at(hostname));
+    this->updateHostIndex(hostname);
+}
+
+/**
+ * @brief Turn a host off
+ *
+ * @param hostname: the host name
+ */
+void SchedulingAlgorithm::turnOffHost(const std::string &hostname) {
+    this->initializeClusterIndex();
+    wrench::Simulation::turnOffHost(hostname);
+    this->off_hosts.insert(this->host_ids.at(hostname));
+    this->updateHostIndex(hostname);
+}
+
+/**
+ * @brief Get the first execution host (in the order of the cloud service) that is off
+ *
+ * @return the host name, or an empty string if all hosts are on
+ */
+std::string SchedulingAlgorithm::getOffHost() {
+    this->initializeClusterIndex();
+    return this->off_hosts.empty() ? "" : this->execution_hosts.at(*this->off_hosts.begin());
+}
+
+/**
+ * @brief Whether a host that is on and already runs VMs has cores that are not allocated to a VM
+ *
+ * @return true if there is such a host
+ */
+bool SchedulingAlgorithm::hasHostWithFreeCores() {
+    this->initializeClusterIndex();
+    return !this->hosts_with_free_cores.empty();
+}
+
+/**
+ * @brief Get the number of cores of a host that are not allocated to a running VM
+ *
+ * @param hostname: the host name
+ *
+ * @return the number of free cores
+ */
+unsigned long SchedulingAlgorithm::getHostNumFreeCores(const std::string &hostname) {
+    this->initializeClusterIndex();
+    auto it = this->host_free_cores.find(hostname);
+    return it == this->host_free_cores.end() ? 0 : it->second;
+}
+
+/**
+ * @brief Get the number of cores of the running VMs of a host that no dispatched task occupies
+ *
+ * @param hostname: the host name
+ *
+ * @return the number of idle VM cores
+ */
+unsigned long SchedulingAlgorithm::getHostNumIdleVMCores(const std::string &hostname) const {
+    auto it = this->available_vms_per_host.find(hostname);
+    if (it == this->available_vms_per_host.end()) {
+        return 0;
+    }
+    unsigned long num_idle_cores = 0;
+    for (auto const &vm_name : it->second) {
+        num_idle_cores += this->getVMNumCores(vm_name) - this->vm_running_tasks.at(vm_name);
+    }
+    return num_idle_cores;
+}
+
+/**
+ * @brief Get the number of cores, over all hosts, that are not allocated to a running VM
+ *
+ * @return the number of free cores
+ */
+unsigned long SchedulingAlgorithm::getTotalNumFreeCores() {
+    this->initializeClusterIndex();
+    return this->total_free_cores;
+}
+
+/**
+ * @brief Get the number of cores of a VM created by the algorithm
+ *
+ * @param vm_name: the VM name
+ *
+ * @return the number of cores
+ */
+unsigned long SchedulingAlgorithm::getVMNumCores(const std::string &vm_name) const {
+    auto it = this->vm_num_cores.find(vm_name);
+    return it == this->vm_num_cores.end() ? 1 : it->second;
+}
+
+/**
+ * @brief Build the index of the cluster state from the cloud service, once the simulation is running; the
+ *        index is then kept current as the algorithm starts and releases VMs and turns hosts on and off
+ */
+void SchedulingAlgorithm::initializeClusterIndex() {
+    if (this->cluster_index_initialized) {
+        return;
+    }
+    this->cluster_index_initialized = true;
+
+    std::map<std::string, unsigned long> idle_cores_host;
+    {
+        Profiler::Pause profiler_pause;
+        this->execution_hosts = this->cloud_service->getExecutionHosts();
+        idle_cores_host = this->cloud_service->getPerHostNumIdleCores();
+    }
+    for (std::size_t i = 0; i < this->execution_hosts.size(); i++) {
+        auto &host = this->execution_hosts[i];
+        this->host_ids[host] = i;
+        if (!wrench::Simulation::isHostOn(host)) {
+            this->off_hosts.insert(i);
+        }
+        auto free_cores = idle_cores_host[host];
+        this->host_free_cores[host] = free_cores;
+        this->hosts_by_free_cores.insert(std::make_pair(free_cores, host));
+        this->total_free_cores += free_cores;
+    }
+}
+
+/**
+ * @brief Update whether a host is on, runs VMs, and has free cores
+ *
+ * @param hostname: the host name
+ */
+void SchedulingAlgorithm::updateHostIndex(const std::string &hostname) {
+    auto &worker_running_cores = this->cluster_state.getWorkerRunningCores();
+    auto running_cores = worker_running_cores.find(hostname);
+    if (running_cores != worker_running_cores.end() &&
+        !this->off_hosts.count(this->host_ids.at(hostname)) &&
+        running_cores->second < (int) wrench::Simulation::getHostNumCores(hostname)) {
+        this->hosts_with_free_cores.insert(hostname);
+    } else {
+        this->hosts_with_free_cores.erase(hostname);
+    }
+}
+
+/**
+ * @brief Update whether a running VM has a free core
+ *
+ * @param vm_name: the VM name
+ * @param vm_pm: the name of the physical host of the VM
+ */
+void SchedulingAlgorithm::updateVMIndex(const std::string &vm_name, const std::string &vm_pm) {
+    auto running_tasks = this->vm_running_tasks.find(vm_name);
+    if (running_tasks != this->vm_running_tasks.end() && running_tasks->second < this->getVMNumCores(vm_name)) {
+        this->available_vms.insert(vm_name);
+        this->available_vms_per_host[vm_pm].insert(vm_name);
+    } else {
+        this->available_vms.erase(vm_name);
+        this->available_vms_per_host[vm_pm].erase(vm_name);
+    }
+}
@@ -10,6 +10,7 @@
 #ifndef ENERGY_AWARE_SCHEDULINGALGORITHM_H
 #define ENERGY_AWARE_SCHEDULINGALGORITHM_H
 
+#include <unordered_set>
 #include <wrench-dev.h>
 
 #include "cost_model/CostModel.h"
@@ -31,11 +32,95 @@ public:
 
     virtual void notifyVMShutdown(const std::string &vm_name, const std::string &vm_pm) = 0;
 
+    std::shared_ptr<wrench::CloudComputeService> getCloudService() const;
+
+    virtual std::string getPlannedHost(const wrench::WorkflowTask *task) const;
+
+    void setVMNumCores(unsigned long num_cores);
+
+    void setNumPendingTasks(unsigned long num_tasks);
+
+    unsigned long getNumVMStarts() const;
+
+    void notifyTaskScheduled(const wrench::WorkflowTask *task);
+
+    void notifyTaskStart(const std::string &vm_name);
+
+    void notifyTaskCompletion(const std::string &vm_name);
+
 protected:
+    virtual double getTaskPriority(const wrench::WorkflowTask *task) const;
+
+    std::vector<wrench::WorkflowTask *> prioritizeTasks(const std::vector<wrench::WorkflowTask *> &tasks);
+
+    std::string createVM();
+
+    std::string startVM(const std::string &vm_name);
+
+    void releaseVM(const std::string &vm_name, const std::string &vm_pm);
+
+    void turnOnHost(const std::string &hostname);
+
+    void turnOffHost(const std::string &hostname);
+
+    std::string getOffHost();
+
+    bool hasHostWithFreeCores();
+
+    unsigned long getHostNumFreeCores(const std::string &hostname);
+
+    unsigned long getHostNumIdleVMCores(const std::string &hostname) const;
+
+    unsigned long getTotalNumFreeCores();
+
+    unsigned long getVMNumCores(const std::string &vm_name) const;
+
     std::shared_ptr<wrench::CloudComputeService> &cloud_service;
     std::unique_ptr<CostModel> cost_model;
     std::map<std::string, std::string> vm_worker_map;
     std::map<std::string, int> worker_running_vms;
+    /** @brief Running VMs and cores of the running VMs of each host, as seen by the cost model */
+    ClusterState cluster_state;
+    /** @brief Number of cores of each VM */
+    std::map<std::string, unsigned long> vm_num_cores;
+    /** @brief Number of cores of new VMs (0 sizes VMs after the number of pending tasks) */
+    unsigned long vm_size = 1;
+    unsigned long num_pending_tasks = 1;
+
+    /** @brief Running VMs that have a free core, overall and per host */
+    std::set<std::string> available_vms;
+    std::map<std::string, std::set<std::string>> available_vms_per_host;
+    /** @brief VMs that were shut down and can be restarted, overall and per host (where they last ran) */
+    std::set<std::string> down_vms;
+    std::map<std::string, std::set<std::string>> down_vms_per_host;
+
+private:
+    void initializeClusterIndex();
+
+    /** @brief Ready tasks seen so far and not scheduled yet, by decreasing priority then task ID */
+    std::map<std::pair<double, std::string>, wrench::WorkflowTask *> ready_queue;
+    std::unordered_set<const wrench::WorkflowTask *> queued_tasks;
+
+    void updateHostIndex(const std::string &hostname);
+
+    void updateVMIndex(const std::string &vm_name, const std::string &vm_pm);
+
+    unsigned long num_vm_starts = 0;
+    bool cluster_index_initialized = false;
+    std::vector<std::string> execution_hosts;
+    std::map<std::string, std::size_t> host_ids;
+    /** @brief Execution hosts that are off, by position in the list of execution hosts */
+    std::set<std::size_t> off_hosts;
+    /** @brief Cores of each host that are not allocated to a running VM */
+    std::map<std::string, unsigned long> host_free_cores;
+    std::set<std::pair<unsigned long, std::string>> hosts_by_free_cores;
+    unsigned long total_free_cores = 0;
+    /** @brief Hosts that are on, run VMs, and still have free cores */
+    std::set<std::string> hosts_with_free_cores;
+    /** @brief Host each started VM runs, or last ran, on */
+    std::map<std::string, std::string> vm_hosts;
+    /** @brief Number of tasks dispatched to each running VM */
+    std::map<std::string, unsigned long> vm_running_tasks;
 };
 
 #endif //ENERGY_AWARE_SCHEDULINGALGORITHM_H